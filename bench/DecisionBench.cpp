@@ -0,0 +1,202 @@
+// Measures the latency and allocations of the decision engine with a large library, without the game.
+// The library has 100k levels spread over 1k playlists, with half of the playlists overridden and a few rules and patterns.
+// Usage: decision-bench [--levels N] [--playlists N]
+
+#include "DecisionEngine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// Every allocation in the process is counted, so the phases can report how many allocations each decision made
+static std::atomic<uint64_t> allocationCount = 0;
+
+void* operator new(size_t size)    {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if(void* ptr = malloc(size ? size : 1))  {return ptr;}
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept    {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept    {
+    free(ptr);
+}
+
+// The cache capacity used in game
+static constexpr size_t CACHE_CAPACITY = 256;
+
+struct Level {
+    std::string id;
+    float notesPerSecond;
+    float peakNotesPerSecond;
+    float duration;
+};
+
+// Same inputs for every call, like the NPS index and pack index give in game once a level has been indexed
+class BenchInputSource : public DecisionInputSource {
+public:
+    BenchInputSource(const Level& level, const LevelPackIndex& packIndex) : level(level), packIndex(packIndex) {}
+
+    std::optional<float> calculateNotesPerSecond() override {return level.notesPerSecond;}
+    float calculatePeakNotesPerSecond() override {return level.peakNotesPerSecond;}
+    std::optional<float> calculateDuration() override {return level.duration;}
+
+    bool findLevelPacks(std::vector<LevelPack>& packs) override {
+        packIndex.forEachPack(level.id, [&](const LevelPack& pack) {packs.push_back(pack);});
+        return true;
+    }
+
+    MeasuredPerformance findMeasuredPerformance() override {return MeasuredPerformance::UNKNOWN;}
+
+private:
+    const Level& level;
+    const LevelPackIndex& packIndex;
+};
+
+// Small deterministic generator, so that every run benchmarks the same library
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static float randomFloat(uint32_t& state, float min, float max) {
+    return min + (nextRandom(state) / (float) UINT32_MAX) * (max - min);
+}
+
+static ConfigSnapshot makeConfig(size_t playlistCount)  {
+    ConfigSnapshot config;
+    config.generation = 1;
+    config.mode = Mode::ENABLE;
+    config.notesPerSecondThreshold = 7.0f;
+    config.densityMode = DensityMode::PEAK;
+
+    auto playlists = std::make_shared<PlaylistIndex>();
+    for(size_t i = 0; i < playlistCount; i += 2)    {
+        playlists->insert("playlist_" + std::to_string(i), "Playlist " + std::to_string(i));
+    }
+    config.playlists = playlists;
+
+    std::vector<std::string> errors;
+    config.playlistPatterns = std::make_shared<const PackMatcher>(PackMatcher::compile({"Ranked *", "*Tech*", "Speed ?"}, errors));
+    config.rules = std::make_shared<const RuleSet>(RuleSet::compile({
+        {"Short Expert+", false, {{"duration", "<", "", 60.0f, true}, {"difficulty", "==", "ExpertPlus", 0.0f, false}}},
+        {"Not standard", false, {{"characteristic", "!=", "Standard", 0.0f, false}}},
+        {"Dense playlist", true, {{"pack", "==", "Playlist 1", 0.0f, false}, {"nps", ">", "", 5.0f, true}}}
+    }, errors));
+    for(const std::string& error : errors)  {
+        fprintf(stderr, "Config error: %s\n", error.c_str());
+    }
+    return config;
+}
+
+// Finds the latency at this percentile (between 0 and 100) of the sorted latencies
+static double getPercentile(const std::vector<uint64_t>& sortedLatencies, double percentile)   {
+    size_t index = std::min(sortedLatencies.size() - 1, (size_t) (percentile / 100.0 * sortedLatencies.size()));
+    return sortedLatencies[index] / 1000.0;
+}
+
+// Decides levelsPerPass levels in order, passes times, timing every decision.
+// If newConfig is set, a new config snapshot is published before each pass
+static void runPhase(const char* name, DecisionEngine& engine, ConfigSnapshot& config, const std::vector<Level>& levels,
+                    size_t firstLevel, size_t levelsPerPass, size_t passes, bool newConfig, const LevelPackIndex& packIndex)   {
+    size_t decisionCount = levelsPerPass * passes;
+    std::vector<uint64_t> latencies;
+    latencies.reserve(decisionCount);
+    uint64_t allocations = 0;
+    size_t overrides = 0;
+    DecisionKey key {"", "Standard", 4};
+
+    for(size_t i = 0; i < decisionCount; i++)   {
+        if(newConfig && i % levelsPerPass == 0) {config.generation++;}
+        const Level& level = levels[(firstLevel + i % levelsPerPass) % levels.size()];
+        key.levelId = level.id;
+        BenchInputSource inputs(level, packIndex);
+
+        uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        std::optional<Decision> decision = engine.decide(config, key, inputs);
+        auto end = std::chrono::steady_clock::now();
+        allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        if(decision && decision->willOverride)  {overrides++;}
+    }
+
+    uint64_t total = 0;
+    for(uint64_t latency : latencies) {total += latency;}
+    std::sort(latencies.begin(), latencies.end());
+    printf("%-16s %9zu decisions  mean %7.3f us  p50 %7.3f us  p99 %7.3f us  p99.9 %7.3f us  max %8.3f us  %6.2f allocations/decision  %zu overridden\n",
+        name, decisionCount,
+        total / 1000.0 / decisionCount,
+        getPercentile(latencies, 50),
+        getPercentile(latencies, 99),
+        getPercentile(latencies, 99.9),
+        latencies.back() / 1000.0,
+        (double) allocations / decisionCount,
+        overrides);
+}
+
+int main(int argc, char** argv) {
+    size_t levelCount = 100000;
+    size_t playlistCount = 1000;
+    for(int i = 1; i < argc; i++)   {
+        if(strcmp(argv[i], "--levels") == 0 && i + 1 < argc)    {
+            levelCount = strtoull(argv[++i], nullptr, 10);
+        }   else if(strcmp(argv[i], "--playlists") == 0 && i + 1 < argc)    {
+            playlistCount = strtoull(argv[++i], nullptr, 10);
+        }   else    {
+            fprintf(stderr, "Usage: %s [--levels N] [--playlists N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(levelCount == 0 || playlistCount == 0)   {
+        fprintf(stderr, "There must be at least one level and playlist\n");
+        return 1;
+    }
+
+    // Build the library. Each level is in one to three playlists, and a few of the playlists match the patterns
+    uint32_t random = 0x9E3779B9;
+    LevelPackIndex packIndex;
+    std::vector<uint32_t> packs;
+    for(size_t i = 0; i < playlistCount; i++)   {
+        std::string name = i % 50 == 0 ? "Ranked " + std::to_string(i) : "Playlist " + std::to_string(i);
+        packs.push_back(packIndex.addPack("playlist_" + std::to_string(i), name));
+    }
+    std::vector<Level> levels(levelCount);
+    for(size_t i = 0; i < levelCount; i++)  {
+        char id[64];
+        snprintf(id, sizeof(id), "custom_level_%08X%08X%08X%08X%08X", nextRandom(random), nextRandom(random), nextRandom(random), nextRandom(random), (uint32_t) i);
+        levels[i] = Level {id, randomFloat(random, 1.0f, 10.0f), 0.0f, randomFloat(random, 30.0f, 400.0f)};
+        levels[i].peakNotesPerSecond = levels[i].notesPerSecond * randomFloat(random, 1.0f, 1.6f);
+
+        uint32_t packsPerLevel = 1 + nextRandom(random) % 3;
+        for(uint32_t j = 0; j < packsPerLevel; j++) {
+            packIndex.addLevel(packs[nextRandom(random) % packs.size()], levels[i].id);
+        }
+    }
+    packIndex.finish();
+
+    ConfigSnapshot config = makeConfig(playlistCount);
+    printf("%zu levels in %zu playlists, %zu pack entries, cache capacity %zu\n", levelCount, playlistCount, packIndex.getLevelCount(), CACHE_CAPACITY);
+
+    DecisionEngine engine(CACHE_CAPACITY);
+    // Scrolling through the whole library misses the cache every time, since it is much smaller than the library
+    runPhase("uncached", engine, config, levels, 0, levelCount, 1, false, packIndex);
+    // Selecting recently seen levels again uses the cached decisions
+    size_t recentCount = std::min(CACHE_CAPACITY, levelCount);
+    size_t recentStart = levelCount - recentCount;
+    runPhase("cached", engine, config, levels, recentStart, recentCount, 100, false, packIndex);
+    // A config change redoes the decisions, but reuses the cached inputs
+    runPhase("config changed", engine, config, levels, recentStart, recentCount, 100, true, packIndex);
+    return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Messages below this level are compiled out. 0 is debug, 1 is info, 2 is warning and 3 is error
+#ifndef AUTO_DEBRIS_LOG_LEVEL
+#define AUTO_DEBRIS_LOG_LEVEL 0
+#endif
+
+enum class LogSeverity : uint8_t {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR,
+    NONE // Only used to turn off logging at runtime
+};
+
+// Parses a level as written in the config, e.g. "warning". Returns the default for anything unknown
+LogSeverity parseLogLevel(const char* name, LogSeverity defaultLevel);
+
+// Sets the lowest level that is logged. Messages that are compiled out can't be turned back on
+void setLogLevel(LogSeverity level);
+
+// Formats the message into the ring buffer to be written by the log thread. This never blocks or allocates.
+// If the buffer is full the message is dropped, and the number of dropped messages is logged later.
+void logAsync(LogSeverity level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+// Starts the thread that writes the queued messages to the logger
+void startLogWriter();
+
+namespace AsyncLogInternal {
+    extern std::atomic<LogSeverity> level;
+}
+
+// Logs through the ring buffer. The level check is a relaxed load, and the arguments aren't evaluated if the level is filtered out
+#define ASYNC_LOG(severity, ...) do { \
+    if constexpr((int) LogSeverity::severity >= AUTO_DEBRIS_LOG_LEVEL) { \
+        if(LogSeverity::severity >= AsyncLogInternal::level.load(std::memory_order_relaxed))    { \
+            logAsync(LogSeverity::severity, __VA_ARGS__); \
+        } \
+    } \
+} while(0)
+
+#define ASYNC_LOG_DEBUG(...) ASYNC_LOG(DEBUG, __VA_ARGS__)
+#define ASYNC_LOG_INFO(...) ASYNC_LOG(INFO, __VA_ARGS__)
+#define ASYNC_LOG_WARNING(...) ASYNC_LOG(WARNING, __VA_ARGS__)
+#define ASYNC_LOG_ERROR(...) ASYNC_LOG(ERROR, __VA_ARGS__)
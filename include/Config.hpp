@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ConfigSnapshot.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Loads the config file from disk, creating the default config if necessary, and publishes the first snapshot.
+void loadConfig();
+
+// Starts the background thread that writes changes back to disk and picks up external edits to the config file.
+void startConfigWriter();
+
+// Gets the current config snapshot. This is just an atomic pointer load, so it is cheap enough to call on every selection.
+std::shared_ptr<const ConfigSnapshot> getConfigSnapshot();
+
+// Applies an edit to a copy of the current snapshot, then publishes it and marks the config as dirty.
+// The background writer coalesces edits and writes them to disk once they stop coming in.
+void editConfig(const std::function<void(ConfigSnapshot&)>& edit);
+
+// Writes any pending changes to disk immediately.
+void flushConfig();
+
+// Applies an edit to a copy of just the overridden playlists. The new snapshot shares everything else with the current one.
+void editPlaylists(const std::function<void(PlaylistIndex&)>& edit);
+
+// Forces the override on or off for one level, or goes back to deciding as usual with LevelOverride::NONE
+void setLevelOverride(std::string_view levelId, LevelOverride state);
+
+// Compiles playlist patterns for a snapshot, logging any that are invalid. Done outside of editConfig, since it can be slow for many patterns.
+std::shared_ptr<const PackMatcher> compilePlaylistPatterns(const std::vector<std::string>& patterns);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "AsyncLog.hpp"
+#include "LevelOverrideList.hpp"
+#include "OverrideFields.hpp"
+#include "PackMatcher.hpp"
+#include "PlaylistIndex.hpp"
+#include "RuleEngine.hpp"
+
+#include <cstdint>
+#include <memory>
+
+enum Mode   {
+    DISABLE = false,
+    ENABLE = true
+};
+
+// Which NPS value the threshold is compared against
+enum class DensityMode {
+    AVERAGE, // Notes divided by the length of the song
+    PEAK // NPS over a sliding window, at the configured percentile of all windows
+};
+
+// Immutable copy of the values in the config file.
+// A new snapshot is published whenever the config changes, so readers never have to touch the rapidjson document.
+struct ConfigSnapshot {
+    uint64_t generation = 0; // Incremented when a snapshot with different decision inputs is published, used to invalidate cached decisions
+
+    Mode mode = Mode::DISABLE;
+    float notesPerSecondThreshold = 5.0f;
+
+    DensityMode densityMode = DensityMode::AVERAGE;
+    float densityWindow = 2.0f; // Length of the sliding window in seconds
+    float densityPercentile = 0.9f; // 1.0 uses the densest window
+
+    // Instead of enabling reduce debris for the whole song, only reduce it during the parts of the song above the threshold
+    bool dynamicDebris = false;
+    float dynamicDebrisLeadTime = 1.0f; // Seconds before a dense part that debris starts being reduced
+    float dynamicDebrisHysteresis = 0.8f; // Debris comes back once the NPS drops below this fraction of the threshold
+
+    // Measure the frame times of each difficulty while playing, and use them instead of the NPS threshold once a difficulty has been played
+    bool adaptiveMode = false;
+    float frameTimePercentile = 0.95f; // Percentile of the frame times compared against the budget
+    float frameTimeBudget = 0.0f; // In milliseconds. 0 uses the refresh rate of the headset
+    // Shared, so that copying the snapshot for an edit doesn't copy the playlist maps unless the edit changes them
+    std::shared_ptr<const PlaylistIndex> playlists = std::make_shared<const PlaylistIndex>();
+    // Playlists are also overridden if their ID or name matches one of these. Shared, since the DFA is only rebuilt when the patterns change
+    std::shared_ptr<const PackMatcher> playlistPatterns = std::make_shared<const PackMatcher>();
+
+    bool profiling = false; // Whether to time the hooks, writing a summary whenever the settings menu is closed
+    LogSeverity logLevel = LogSeverity::INFO; // Lowest level of the messages logged from the hooks
+    bool traceRecording = false; // Whether to record the hook events to a trace file, which can be replayed with tools/replay
+
+    // User defined rules, compiled when the config is loaded. These are checked before the threshold and playlists
+    std::shared_ptr<const RuleSet> rules = std::make_shared<const RuleSet>();
+
+    // Levels that are always or never overridden, which take precedence over everything else.
+    // These are saved to their own binary file rather than the config, since curated lists can hold thousands of levels
+    std::shared_ptr<const LevelOverrideList> levelOverrides = std::make_shared<const LevelOverrideList>();
+
+    // Other settings to change along with reduce debris when overriding. Like the rules, these are only edited in the config file
+    OverrideSet overrideFields;
+
+    // Whether the decision engine would decide the same with either snapshot.
+    // The shared parts are only replaced when they are edited, so they are compared by pointer rather than by contents
+    bool hasSameDecisionInputs(const ConfigSnapshot& other) const {
+        return mode == other.mode
+            && notesPerSecondThreshold == other.notesPerSecondThreshold
+            && densityMode == other.densityMode
+            && densityWindow == other.densityWindow
+            && densityPercentile == other.densityPercentile
+            && adaptiveMode == other.adaptiveMode
+            && playlists == other.playlists
+            && playlistPatterns == other.playlistPatterns
+            && rules == other.rules
+            && levelOverrides == other.levelOverrides;
+    }
+};
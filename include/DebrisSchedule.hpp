@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+// A part of the song where debris is reduced, in seconds
+struct DebrisInterval {
+    float start;
+    float end;
+};
+
+struct DebrisScheduleSettings {
+    float windowSeconds; // Length of the sliding window that the NPS is measured over
+    float reduceNotesPerSecond; // Debris is reduced once the NPS goes above this
+    float restoreNotesPerSecond; // and only comes back once it drops below this, so that it doesn't flicker around the threshold
+    float leadTime; // How long before a dense section to start reducing debris
+    float minimumGap; // Intervals closer together than this are joined into one
+};
+
+// When to reduce debris during a song, worked out from the note times before the level starts.
+// The intervals are sorted and don't overlap, so applying the schedule during the song is just walking forward through them.
+class DebrisSchedule {
+public:
+    // Notes after this are left out, so that a malformed note time can't make the window walk along forever
+    static constexpr float MAX_LENGTH_SECONDS = 4 * 60 * 60;
+
+    // The note times must be sorted, in seconds
+    static DebrisSchedule build(const std::vector<float>& noteTimes, const DebrisScheduleSettings& settings);
+
+    const std::vector<DebrisInterval>& getIntervals() const {return intervals;}
+    bool empty() const {return intervals.empty();}
+
+private:
+    std::vector<DebrisInterval> intervals;
+};
+
+// Position in a schedule as the song plays. Moving forward is amortized constant time with no searching.
+// Going backwards, e.g. when practice mode seeks, starts again from the beginning of the schedule.
+class DebrisScheduleCursor {
+public:
+    DebrisScheduleCursor() = default;
+    explicit DebrisScheduleCursor(const DebrisSchedule& schedule);
+
+    bool isReduced(float songTime);
+
+private:
+    const DebrisInterval* begin = nullptr;
+    const DebrisInterval* current = nullptr; // First interval that doesn't end before the last song time
+    const DebrisInterval* end = nullptr;
+    float lastSongTime = 0.0f;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "LevelPackIndex.hpp"
+#include "PerformanceProfile.hpp"
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class OverrideReason;
+
+// Identifies one difficulty of one level
+struct DecisionKey {
+    std::string levelId;
+    std::string characteristic; // Serialized name of the beatmap characteristic, e.g. "Standard"
+    int difficulty;
+
+    bool operator==(const DecisionKey& other) const {
+        return difficulty == other.difficulty && levelId == other.levelId && characteristic == other.characteristic;
+    }
+};
+
+struct DecisionKeyHash {
+    size_t operator()(const DecisionKey& key) const;
+};
+
+// The inputs to the override decision for a difficulty, and the last decision made from them.
+// The inputs never change for a difficulty, so only the decision needs to be redone when the config changes.
+struct CachedDecision {
+    std::optional<float> notesPerSecond; // Only calculated if the NPS threshold is enabled
+    std::optional<float> peakNotesPerSecond; // Only calculated in peak density mode. Negative if the density isn't known
+    std::optional<float> duration; // Only calculated if a rule depends on it
+    std::optional<MeasuredPerformance> measuredPerformance; // Only found in adaptive mode. Decisions are cleared when a new play is measured
+
+    bool packsKnown = false;
+    std::vector<LevelPack> packs; // Every pack the level is in
+    std::vector<uint64_t> packHashes; // Hashes of the IDs and names of the packs, which the rules compare against
+
+    uint64_t configGeneration = UINT64_MAX; // Generation of the config snapshot the decision was made with
+    bool willOverride = false;
+    OverrideReason reason{};
+    int rule = -1; // Index of the rule that made the decision, if any
+};
+
+// Bounded, least recently used cache of override decisions
+class DecisionCache {
+public:
+    explicit DecisionCache(size_t capacity);
+
+    // Finds the entry for this key, creating an empty one if it isn't cached.
+    // The entry is marked as most recently used, and the least recently used entry is evicted if the cache is full.
+    CachedDecision& getOrInsert(const DecisionKey& key);
+
+    void clear();
+
+private:
+    using Entry = std::pair<DecisionKey, CachedDecision>;
+
+    size_t capacity;
+    std::list<Entry> entries; // Ordered from most to least recently used
+    std::unordered_map<DecisionKey, std::list<Entry>::iterator, DecisionKeyHash> lookup;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ConfigSnapshot.hpp"
+#include "DecisionCache.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// Why a decision was made
+enum class OverrideReason {
+    NONE,
+    NPS_THRESHOLD,
+    PEAK_DENSITY,
+    PLAYLIST,
+    RULE,
+    FRAME_TIME,
+    LEVEL
+};
+
+// Converts a reason to a string for logging
+const char* reasonToString(OverrideReason reason);
+
+struct Decision {
+    bool willOverride;
+    OverrideReason reason;
+    int rule = -1; // Index of the rule in the config's rule set if the reason is RULE
+};
+
+// Provides the inputs to a decision that are expensive to find.
+// These are only requested if the decision needs them and they aren't already cached.
+// A source that can't reach the game (e.g. on a background thread) returns nullopt or false for inputs it can't find yet.
+class DecisionInputSource {
+public:
+    virtual ~DecisionInputSource() = default;
+
+    virtual std::optional<float> calculateNotesPerSecond() = 0;
+    // Finds the NPS at the configured percentile of the sliding windows, returning a negative value if it isn't known
+    virtual float calculatePeakNotesPerSecond() = 0;
+    // Finds the length of the song in seconds
+    virtual std::optional<float> calculateDuration() = 0;
+    // Adds every pack that the level is in to packs, which is left empty if the level isn't in a pack
+    virtual bool findLevelPacks(std::vector<LevelPack>& packs) = 0;
+    // Finds whether earlier plays of the difficulty went over the frame budget
+    virtual MeasuredPerformance findMeasuredPerformance() = 0;
+};
+
+// Decides whether to override the debris setting for a difficulty.
+// This only depends on the config snapshot and the input source, so it doesn't need the game to run.
+class DecisionEngine {
+public:
+    explicit DecisionEngine(size_t cacheCapacity);
+
+    // Forgets every cached decision and input. Used when the loaded packs change
+    void clear();
+
+    // Makes the decision for this difficulty, reusing the cached decision if the config hasn't changed since it was made.
+    // Returns nullopt if the input source couldn't provide an input, in which case any inputs it did find are still cached.
+    // Not thread safe, callers on different threads need to share a lock.
+    std::optional<Decision> decide(const ConfigSnapshot& config, const DecisionKey& key, DecisionInputSource& inputs);
+
+private:
+    DecisionCache cache;
+    // The density settings of the peak NPS in the cache. The cache is cleared if these change
+    float cachedDensityWindow = 0.0f;
+    float cachedDensityPercentile = 0.0f;
+
+    static std::optional<Decision> decideUncached(const ConfigSnapshot& config, const DecisionKey& key, CachedDecision& cached, DecisionInputSource& inputs);
+    static bool findPacks(CachedDecision& cached, DecisionInputSource& inputs);
+    static std::optional<RuleInputs> findRuleInputs(const RuleSet& rules, const DecisionKey& key, CachedDecision& cached, DecisionInputSource& inputs);
+};
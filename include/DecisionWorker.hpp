@@ -0,0 +1,23 @@
+#pragma once
+
+#include "DecisionEngine.hpp"
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+// Starts deciding whether to override for the selected difficulty on a background thread.
+// Only the most recent request matters, so this cancels any request that hasn't finished yet.
+// The background thread only uses the NPS and pack indices, so difficulties that aren't indexed are left for the main thread to decide.
+void requestDecision(DecisionKey key);
+
+// Waits for the background decision for this difficulty, for up to the timeout.
+// Returns nullopt if a different difficulty was requested last, or the decision couldn't be made in the background.
+std::optional<Decision> waitForDecision(const DecisionKey& key, std::chrono::milliseconds timeout);
+
+// Makes the decision on the calling thread, sharing the background thread's cache.
+// The input source must be able to find every input, so this is only used on the main thread.
+Decision decideNow(const ConfigSnapshot& config, const DecisionKey& key, DecisionInputSource& inputs);
+
+// Forgets every cached decision, for when the inputs have changed. Used when the loaded packs change
+void clearDecisions();
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Note density of one difficulty over a sliding window
+struct DensityResult {
+    float peakNotesPerSecond; // Highest NPS of any window
+    float percentileNotesPerSecond; // NPS of the window at the configured percentile
+};
+
+// Finds the note density of difficulties over a sliding window.
+// Notes are counted into bins a fraction of the window wide, then each window is the sum of consecutive bins.
+// All of the work is done on flat arrays that are reused between difficulties, so analyzing the difficulties
+// of a level one after another only allocates when a longer song comes along.
+class DensityAnalyzer {
+public:
+    // Windows are snapped to multiples of this fraction of the window length
+    static constexpr int BINS_PER_WINDOW = 8;
+    // Notes up to this long after the end of the audio are still counted. Later ones can't be played, and are usually a malformed time
+    static constexpr float LATE_NOTE_SECONDS = 10.0f;
+    // Bounds the number of bins if the song duration itself is malformed
+    static constexpr float MAX_LENGTH_SECONDS = 4 * 60 * 60;
+
+    // The percentile should be between 0 and 1, where 1 is the same as the peak
+    DensityAnalyzer(float windowSeconds, float percentile);
+
+    // Analyzes a difficulty. The note times must be sorted, in seconds
+    DensityResult analyze(const std::vector<float>& noteTimes, float songDuration);
+
+private:
+    float windowSeconds;
+    float binSeconds;
+    float percentile;
+
+    std::vector<uint32_t> prefixCounts; // Number of notes before the start of each bin
+    std::vector<uint32_t> windowCounts; // Number of notes in the window starting at each bin
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+// Converts a difficulty name as used in info.dat (e.g. "ExpertPlus") to the value of the BeatmapDifficulty enum
+constexpr std::optional<int> parseDifficultyName(std::string_view name)    {
+    constexpr std::string_view DIFFICULTY_NAMES[] = {"Easy", "Normal", "Hard", "Expert", "ExpertPlus"};
+    for(int i = 0; i < 5; i++)  {
+        if(name == DIFFICULTY_NAMES[i]) {return i;}
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ConfigSnapshot.hpp"
+#include "DecisionCache.hpp"
+
+#include "GlobalNamespace/IPreviewBeatmapLevel.hpp"
+
+// Starts building the debris schedule for a level that is starting, if dynamic debris is enabled and the level can be read from disk.
+// The schedule is built in the background from the level's files. Must be called on the main thread.
+// Returns false if the level should have reduce debris overridden for the whole song instead.
+bool startDynamicDebris(GlobalNamespace::IPreviewBeatmapLevel* level, const DecisionKey& key, const ConfigSnapshot& config);
+
+// Stops using the schedule of the last level, for a level which doesn't use dynamic debris. Must be called on the main thread.
+void stopDynamicDebris();
+
+bool isDynamicDebrisActive();
+
+// Whether debris should be reduced at this time in the current level. Must be called on the main thread.
+// This only walks forward through the schedule, so it is cheap enough to call for every cut.
+bool isDebrisReduced(float songTime);
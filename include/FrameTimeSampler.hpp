@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+// Collects the frame times of a level in a fixed size ring buffer, so sampling never allocates.
+// Every half buffer, the percentile of the whole buffer is found, and the worst of these is the result.
+// This measures a long song by its slowest stretch, rather than letting the easy parts average it out.
+class FrameTimeSampler {
+public:
+    static constexpr size_t CAPACITY = 2048; // About 28 seconds at 72 Hz
+    static constexpr size_t MINIMUM_SAMPLES = 600; // Shorter plays, e.g. quitting straight away, aren't recorded
+
+    // Starts a new level. The percentile is between 0 and 1
+    void reset(float percentile);
+    // Adds the length of one frame in milliseconds
+    void addSample(float frameTime);
+    // Returns the worst percentile frame time of the level, or nullopt if too few frames were sampled
+    std::optional<float> finish();
+
+    size_t getSampleCount() const {return totalSamples;}
+
+private:
+    std::array<float, CAPACITY> samples;
+    std::array<float, CAPACITY> scratch; // Copy of the samples to partially sort, so the ring isn't reordered
+    size_t next = 0; // Where the next sample goes in the ring
+    size_t totalSamples = 0;
+    size_t sinceMeasured = 0; // Samples added since the percentile was last found
+    float percentile = 0.95f;
+    float worst = 0.0f;
+
+    void measure();
+};
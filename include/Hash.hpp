@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+
+// 64 bit FNV-1a, which is stable between runs unlike std::hash, so it can be saved to disk
+constexpr uint64_t hashString(std::string_view data, uint64_t hash = FNV_OFFSET_BASIS)  {
+    for(char c : data)  {
+        hash ^= (uint8_t) c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
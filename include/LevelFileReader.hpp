@@ -0,0 +1,29 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// The notes of one difficulty, read from its beatmap file
+struct DifficultyNotes {
+    std::string characteristic; // Serialized name of the beatmap characteristic, e.g. "Standard"
+    int difficulty; // Same values as the BeatmapDifficulty enum
+    std::vector<float> noteTimes; // Times of the cuttable notes in seconds, in ascending order
+};
+
+// All difficulties of a custom level, read directly from the files in its folder
+struct LevelFileData {
+    float songDuration = 0.0f; // Length of the song in seconds, or 0 if it couldn't be found
+    std::vector<DifficultyNotes> difficulties;
+};
+
+// Reads the info.dat and beatmap files of the custom level in this folder.
+// This doesn't use any il2cpp or Unity APIs, so it is safe to call from any thread.
+std::optional<LevelFileData> readLevelFiles(const std::string& levelPath);
+
+// Reads the note times of only one difficulty of a custom level, without reading the other beatmaps or the audio.
+// Returns nullopt if the level or that difficulty couldn't be read. Safe to call from any thread.
+std::optional<std::vector<float>> readLevelDifficulty(const std::string& levelPath, const std::string& characteristic, int difficulty);
+
+// Finds the length in seconds of an ogg vorbis file from its headers, without decoding it. Returns 0 if it couldn't be found
+float readOggDuration(const std::string& path);
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "GlobalNamespace/StandardLevelDetailView.hpp"
+
+#include <string>
+
+// Shows the level override of the selected level on the level detail view, creating the button the first time.
+// Clicking the button cycles between deciding as usual, always overriding and never overriding. Must be called on the main thread.
+void updateLevelOverrideButton(GlobalNamespace::StandardLevelDetailView* view, std::string levelId);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Whether the setting is forced for one level, regardless of anything else in the config
+enum class LevelOverride : uint8_t {
+    NONE, // Decided by the rules, threshold and playlists as usual
+    ALWAYS,
+    NEVER
+};
+
+// Levels with a forced override, which can be thousands of levels for curated lists.
+// These are kept as sorted level ID hashes with a parallel array of states, so lookups are a binary search over 8 bytes per level.
+// The file is a header followed by the two arrays, so it is loaded with two reads rather than parsing any JSON.
+class LevelOverrideList {
+public:
+    static constexpr uint32_t MAGIC = 0x4F4C4441; // "ADLO"
+    static constexpr uint32_t VERSION = 1;
+
+    // Reads the list at this path, returning an empty list if it doesn't exist or is invalid
+    static LevelOverrideList read(const std::string& path);
+    // The list is written to a temporary file first then renamed, so a crash while writing doesn't lose the old one
+    bool write(const std::string& path) const;
+
+    LevelOverride find(std::string_view levelId) const;
+    LevelOverride find(uint64_t levelHash) const;
+
+    // Setting a level to NONE removes it from the list
+    void set(std::string_view levelId, LevelOverride state);
+    void set(uint64_t levelHash, LevelOverride state);
+
+    size_t size() const {return hashes.size();}
+    bool empty() const {return hashes.empty();}
+    const std::vector<uint64_t>& getHashes() const {return hashes;}
+    const std::vector<LevelOverride>& getStates() const {return states;}
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+        uint32_t padding;
+    };
+
+    std::vector<uint64_t> hashes; // Hashes of the level IDs, the same as the NPS index's level hashes
+    std::vector<LevelOverride> states;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A pack that a level is in
+struct LevelPack {
+    std::string id;
+    std::string name;
+};
+
+// Maps level IDs to every pack that contains them, so that finding a level's packs doesn't need to search every pack.
+// Built on the main thread whenever the loaded packs change, then only read, so it can be shared with other threads.
+class LevelPackIndex {
+public:
+    // Adds a pack to the index, returning the index of the pack to add its levels with
+    uint32_t addPack(std::string_view packId, std::string_view packName);
+    void addLevel(uint32_t pack, std::string_view levelId);
+    // Sorts the levels so that they can be searched. Must be called once everything has been added
+    void finish();
+
+    // Calls the function with every pack containing the level
+    template<typename F>
+    void forEachPack(std::string_view levelId, F&& f) const {
+        uint64_t levelHash = hashLevel(levelId);
+        auto it = std::lower_bound(levels.begin(), levels.end(), levelHash, [](const LevelEntry& entry, uint64_t hash) {return entry.hash < hash;});
+        for(; it != levels.end() && it->hash == levelHash; it++)   {
+            // Another level whose ID has the same hash isn't in the same packs
+            if(getLevelId(*it) == levelId)  {
+                f(packs[it->pack]);
+            }
+        }
+    }
+
+    size_t getPackCount() const {return packs.size();}
+    size_t getLevelCount() const {return levels.size();}
+
+private:
+    // A level in one of the packs
+    struct LevelEntry {
+        uint64_t hash; // Hash of the level ID, which the entries are sorted by
+        uint32_t pack;
+        uint32_t idOffset; // Position of the level ID in levelIds
+        uint32_t idLength;
+    };
+
+    std::vector<LevelPack> packs;
+    std::vector<LevelEntry> levels;
+    // The level IDs one after another. A level in several packs only has its ID stored once after finish
+    std::string levelIds;
+
+    std::string_view getLevelId(const LevelEntry& entry) const {return std::string_view(levelIds).substr(entry.idOffset, entry.idLength);}
+
+    static uint64_t hashLevel(std::string_view levelId);
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "GlobalNamespace/BeatmapLevelsModel.hpp"
+#include "LevelPackIndex.hpp"
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Rebuilds the level to pack index from all of the loaded packs.
+// Must be called on the main thread, whenever the loaded packs change.
+void updateLevelPacks(GlobalNamespace::BeatmapLevelsModel* beatmapLevelsModel);
+
+// Finds every pack the level is in, adding them to packs. Safe to call from any thread.
+// Returns false if the index hasn't been built yet.
+bool findLevelPacks(std::string_view levelId, std::vector<LevelPack>& packs);
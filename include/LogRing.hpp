@@ -0,0 +1,87 @@
+#pragma once
+
+#include "AsyncLog.hpp"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Bounded multi-producer multi-consumer queue of formatted messages, as described by Dmitry Vyukov.
+// Each slot's sequence number says whether it is ready to be written to or read from, so producers only contend on one counter.
+// Messages longer than MessageLength are truncated. Capacity must be a power of 2
+template<size_t Capacity, size_t MessageLength>
+class LogRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity of a log ring must be a power of 2");
+
+public:
+    LogRing()   {
+        for(size_t i = 0; i < Capacity; i++)   {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Formats the message into the next free slot. If the ring is full the message is dropped and counted, and this returns false
+    bool push(LogSeverity level, const char* format, va_list args)  {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while(true) {
+            slot = &slots[position & (Capacity - 1)];
+            intptr_t difference = (intptr_t) slot->sequence.load(std::memory_order_acquire) - (intptr_t) position;
+            if(difference == 0) {
+                if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))    {break;}
+            }   else if(difference < 0)    {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false; // The buffer is full
+            }   else    {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        vsnprintf(slot->text, MessageLength, format, args);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Calls the function with the oldest message, returning false if there aren't any
+    template<typename F>
+    bool pop(F&& f) {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while(true) {
+            slot = &slots[position & (Capacity - 1)];
+            intptr_t difference = (intptr_t) slot->sequence.load(std::memory_order_acquire) - (intptr_t) (position + 1);
+            if(difference == 0) {
+                if(dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))    {break;}
+            }   else if(difference < 0)    {
+                return false; // The buffer is empty
+            }   else    {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        f(slot->level, (const char*) slot->text);
+        slot->sequence.store(position + Capacity, std::memory_order_release);
+        return true;
+    }
+
+    // Returns the number of messages dropped since the last call
+    uint64_t takeDropped()  {
+        return dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogSeverity level;
+        char text[MessageLength];
+    };
+
+    // Kept on separate cache lines so that producers and the consumer don't slow each other down
+    alignas(64) std::atomic<size_t> enqueuePosition = 0;
+    alignas(64) std::atomic<size_t> dequeuePosition = 0;
+    std::atomic<uint64_t> dropped = 0;
+    Slot slots[Capacity];
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Hashes the level ID, characteristic and difficulty into the key used for the index
+uint64_t hashDifficultyKey(std::string_view levelId, std::string_view characteristic, int difficulty);
+// Hashes just the level ID. Used to track which levels have been fully indexed
+uint64_t hashLevelId(std::string_view levelId);
+
+// One indexed difficulty. This is written directly to the index file, so the layout must not change without bumping the version
+struct NpsIndexEntry {
+    uint64_t key;
+    uint32_t notesCount;
+    float duration; // Song length in seconds
+    // Sliding window density, using the window and percentile in the header. 0 if the difficulty wasn't analyzed
+    float peakNotesPerSecond;
+    float percentileNotesPerSecond;
+
+    float getNotesPerSecond() const {
+        return notesCount / duration;
+    }
+};
+static_assert(sizeof(NpsIndexEntry) == 24);
+
+// Read-only view of an NPS index file, which is memory mapped rather than read into memory.
+// The file consists of a header, the entries sorted by key, then the sorted hashes of the levels that were fully indexed.
+class NpsIndex {
+public:
+    static constexpr uint32_t MAGIC = 0x494E4441; // "ADNI"
+    static constexpr uint32_t VERSION = 2;
+
+    // Maps the index at the given path. Returns nullptr if it doesn't exist or is invalid
+    static std::shared_ptr<const NpsIndex> open(const std::string& path);
+
+    // Sorts the entries and level hashes, then writes them to the given path.
+    // The index is written to a temporary file first then renamed, so existing mappings of the old index stay valid.
+    static bool write(const std::string& path, std::vector<NpsIndexEntry> entries, std::vector<uint64_t> levels, float densityWindow, float densityPercentile);
+
+    ~NpsIndex();
+    NpsIndex(const NpsIndex&) = delete;
+    NpsIndex& operator=(const NpsIndex&) = delete;
+
+    // Binary searches for the entry with this key, returning nullptr if it wasn't found
+    const NpsIndexEntry* find(uint64_t key) const;
+    // Returns true if every difficulty of the level with this hash has been indexed
+    bool containsLevel(uint64_t levelHash) const;
+
+    // Returns true if the density in the entries was found with these settings
+    bool hasDensitySettings(float densityWindow, float densityPercentile) const {
+        return this->densityWindow == densityWindow && this->densityPercentile == densityPercentile;
+    }
+
+    float getDensityWindow() const {return densityWindow;}
+    float getDensityPercentile() const {return densityPercentile;}
+
+    const NpsIndexEntry* entriesBegin() const {return entries;}
+    const NpsIndexEntry* entriesEnd() const {return entries + entryCount;}
+    const uint64_t* levelsBegin() const {return levels;}
+    const uint64_t* levelsEnd() const {return levels + levelCount;}
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t levelCount;
+        float densityWindow;
+        float densityPercentile;
+    };
+
+    NpsIndex() = default;
+
+    void* mapping = nullptr;
+    size_t mappingLength = 0;
+
+    const NpsIndexEntry* entries = nullptr;
+    uint32_t entryCount = 0;
+    const uint64_t* levels = nullptr;
+    uint32_t levelCount = 0;
+    float densityWindow = 0.0f;
+    float densityPercentile = 0.0f;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "GlobalNamespace/BeatmapLevelsModel.hpp"
+#include "NpsIndex.hpp"
+
+#include <optional>
+#include <string_view>
+
+// Maps the NPS index saved by previous sessions, if there is one. Called from setup
+void loadNpsIndex();
+
+// Queues any levels in the loaded packs that aren't in the index yet to be indexed in the background.
+// Must be called on the main thread, since it reads the level packs.
+void updateNpsIndex(GlobalNamespace::BeatmapLevelsModel* beatmapLevelsModel);
+
+// Finds the indexed note count, length and density of a difficulty, returning nullopt if it hasn't been indexed.
+// The density is 0 if it wasn't found, or was found with different density settings to the current config.
+std::optional<NpsIndexEntry> findIndexedDifficulty(std::string_view levelId, std::string_view characteristic, int difficulty);
+
+// Records the NPS of a difficulty that had to be calculated on the main thread, so that it is saved with the next index rebuild
+void recordNotesPerSecond(std::string_view levelId, std::string_view characteristic, int difficulty, int notesCount, float duration);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Player settings that can be changed when a level is overridden
+enum class OverrideField : uint8_t {
+    REDUCE_DEBRIS, // Always set from the override mode, so this can't be set in the config
+    SABER_TRAIL_INTENSITY,
+    HIDE_NOTE_SPAWN_EFFECT,
+    NO_TEXTS_AND_HUDS,
+    NO_FAIL_EFFECTS,
+    COUNT
+};
+
+// Names of the fields as used in the config, which match the names of the PlayerSpecificSettings fields
+constexpr std::array<std::string_view, (size_t) OverrideField::COUNT> OVERRIDE_FIELD_NAMES = {
+    "reduceDebris",
+    "saberTrailIntensity",
+    "hideNoteSpawnEffect",
+    "noTextsAndHuds",
+    "noFailEffects"
+};
+
+constexpr std::optional<OverrideField> parseOverrideField(std::string_view name)    {
+    for(size_t i = 0; i < OVERRIDE_FIELD_NAMES.size(); i++) {
+        if(OVERRIDE_FIELD_NAMES[i] == name) {return (OverrideField) i;}
+    }
+    return std::nullopt;
+}
+
+// The values to set each overridden field to. Bool fields are stored as 0 or 1
+class OverrideSet {
+public:
+    void set(OverrideField field, float value)  {
+        values[(size_t) field] = value;
+        setFields |= 1u << (uint32_t) field;
+    }
+
+    std::optional<float> get(OverrideField field) const {
+        if(!(setFields & (1u << (uint32_t) field)))   {return std::nullopt;}
+        return values[(size_t) field];
+    }
+
+    bool empty() const {return setFields == 0;}
+
+private:
+    std::array<float, (size_t) OverrideField::COUNT> values{};
+    uint32_t setFields = 0;
+};
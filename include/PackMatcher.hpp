@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Matches pack names against glob patterns, e.g. "Ranked *" or "Ranked ?★".
+// "*" matches any number of characters, "?" matches one character and "\" matches the next character literally.
+// Matching ignores ASCII case.
+// All of the patterns are compiled into one DFA, so a lookup is one table step per byte however many patterns there are.
+class PackMatcher {
+public:
+    // Compiles the patterns, skipping any which are invalid and adding a message for each to errors
+    static PackMatcher compile(const std::vector<std::string>& patterns, std::vector<std::string>& errors);
+
+    // Returns true if any pattern matches the whole of the name
+    bool matches(std::string_view name) const;
+
+    bool empty() const {return patterns.empty();}
+    // The patterns as written, so that they can be written back to the config
+    const std::vector<std::string>& getPatterns() const {return patterns;}
+
+    // Returns true if the string contains any wildcards, rather than just being a name
+    static bool isPattern(std::string_view str);
+
+private:
+    static constexpr uint32_t DEAD_STATE = 0; // Can never reach an accepting state, so matching stops early
+    static constexpr uint32_t START_STATE = 1;
+
+    std::vector<std::string> patterns;
+
+    uint8_t byteClasses[256] = {}; // Bytes which every pattern treats the same way share a class, which keeps the table small
+    uint32_t classCount = 1;
+    std::vector<uint32_t> transitions; // Next state for each state and byte class, indexed by state * classCount + class
+    std::vector<uint8_t> accepting;
+};
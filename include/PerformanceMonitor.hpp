@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ConfigSnapshot.hpp"
+#include "DecisionCache.hpp"
+#include "PerformanceProfile.hpp"
+
+#include <string_view>
+
+// Reads the performance profile saved by previous sessions, if there is one. Called from setup
+void loadPerformanceProfile();
+
+// Finds whether earlier plays of a difficulty went over the frame budget. Safe to call from any thread
+MeasuredPerformance findMeasuredPerformance(std::string_view levelId, std::string_view characteristic, int difficulty);
+
+// Starts sampling the frame times of a level that is starting, if adaptive mode is enabled. Must be called on the main thread
+void startFrameTimeSampling(const DecisionKey& key, bool debrisReduced, const ConfigSnapshot& config);
+// Stops sampling without recording anything, e.g. for a multiplayer level
+void stopFrameTimeSampling();
+// Samples the length of the current frame. Called every frame during a level, and does nothing unless sampling
+void sampleFrameTime(float songTime);
+// Records the frame times of the level that just finished in the profile, then saves the profile in the background
+void finishFrameTimeSampling();
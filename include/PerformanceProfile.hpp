@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What earlier plays of a difficulty found out about its frame times
+enum class MeasuredPerformance : uint8_t {
+    UNKNOWN, // Not played in adaptive mode yet, or only played with debris reduced and within budget
+    WITHIN_BUDGET,
+    OVER_BUDGET
+};
+
+// The measurements of one difficulty. This is written directly to the profile file, so the layout must not change without bumping the version
+struct PerformanceEntry {
+    uint64_t key; // From hashDifficultyKey
+    float frameTime; // Frame time at the configured percentile in the last play, in milliseconds
+    float budget; // Frame budget of the headset in the last play, in milliseconds
+    MeasuredPerformance performance;
+    uint8_t padding[7];
+};
+static_assert(sizeof(PerformanceEntry) == 24);
+
+// Frame time measurements of every difficulty played in adaptive mode, sorted by key.
+// The file is a small header followed by the entries, so it is read into memory rather than mapped like the NPS index.
+class PerformanceProfile {
+public:
+    static constexpr uint32_t MAGIC = 0x50504441; // "ADPP"
+    static constexpr uint32_t VERSION = 1;
+
+    // Reads the profile at this path, returning an empty profile if it doesn't exist or is invalid
+    static PerformanceProfile read(const std::string& path);
+    // The profile is written to a temporary file first then renamed, so a crash while writing doesn't lose the old one
+    bool write(const std::string& path) const;
+
+    // Binary searches for the entry with this key, returning nullptr if it wasn't found
+    const PerformanceEntry* find(uint64_t key) const;
+    MeasuredPerformance getPerformance(uint64_t key) const;
+
+    // Records a play of a difficulty.
+    // A play with debris reduced can only show that a difficulty is over budget, since it would only have been slower with debris on.
+    void record(uint64_t key, float frameTime, float budget, bool debrisReduced);
+
+    size_t size() const {return entries.size();}
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t padding;
+    };
+
+    std::vector<PerformanceEntry> entries;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Hashed set of the playlists that are overridden, indexed by both pack ID and display name.
+// Lookups take string_views so that callers don't need to allocate a std::string for every check.
+class PlaylistIndex {
+public:
+    // Adds a playlist to the index. Either argument may be empty if it isn't known
+    void insert(std::string_view packId, std::string_view packName);
+    // Adds a playlist using strings that are already shared, e.g. by the settings menu, so that the strings aren't copied
+    void insert(const std::shared_ptr<const std::string>& packId, const std::shared_ptr<const std::string>& packName);
+    // Removes a playlist from the index, matching on either its ID or name
+    void erase(std::string_view packId, std::string_view packName);
+
+    // Returns true if either the ID or the name of the pack is overridden
+    bool contains(std::string_view packId, std::string_view packName) const;
+    bool empty() const {return ids.empty() && names.empty();}
+
+    // Calls the function with each stored pack ID or name. Used for writing the index back to the config
+    template<typename F>
+    void forEachId(F&& f) const {
+        for(const auto& [id, _] : ids) {f(id);}
+    }
+    template<typename F>
+    void forEachName(F&& f) const {
+        for(const auto& [name, _] : names) {f(name);}
+    }
+
+private:
+    // The keys point into the shared strings, which never move, so the maps can be copied safely
+    using StringSet = std::unordered_map<std::string_view, std::shared_ptr<const std::string>>;
+    StringSet ids;
+    StringSet names;
+
+    static void insertInto(StringSet& set, std::string_view value);
+    static void insertInto(StringSet& set, const std::shared_ptr<const std::string>& value);
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Set to 0 to compile out all of the timers
+#ifndef AUTO_DEBRIS_PROFILING
+#define AUTO_DEBRIS_PROFILING 1
+#endif
+
+// The code that is timed. Hooks only time the work that we add, not the original method
+enum class ProfilePoint {
+    REFRESH_CONTENT,
+    START_STANDARD_LEVEL,
+    START_MULTIPLAYER_LEVEL,
+    CONFIG_READ,
+    AUDIO_LENGTH,
+    BEATMAP_DATA,
+    PACK_LOOKUP,
+    COUNT
+};
+
+const char* profilePointToString(ProfilePoint point);
+
+// Histogram of latencies with logarithmic buckets, each split into linear sub-buckets, in the style of HdrHistogram.
+// Recording is a couple of relaxed atomic adds, so it is lock-free and can be done from any thread.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4; // Values are recorded to within 1/16 of their magnitude
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    void record(uint64_t nanoseconds);
+    void reset();
+
+    uint64_t getCount() const;
+    uint64_t getMax() const;
+    double getMean() const;
+    // Finds the value at this percentile (between 0 and 100), to the precision of the buckets
+    uint64_t getPercentile(double percentile) const;
+
+private:
+    std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> sum = 0;
+    std::atomic<uint64_t> max = 0;
+
+    static int getBucketIndex(uint64_t value);
+    static uint64_t getBucketValue(int index); // Highest value that falls into the bucket
+};
+
+void setProfilingEnabled(bool enabled);
+LatencyHistogram& getHistogram(ProfilePoint point);
+
+// Returns a summary of every histogram with samples in it, one line per point
+std::string getProfilingSummary();
+// Writes the summary to a file, returning false if it couldn't be written
+bool writeProfilingSummary(const std::string& path);
+// Clears every histogram
+void resetProfiling();
+
+namespace ProfilingInternal {
+    extern std::atomic<bool> enabled;
+}
+
+// Records the time between its construction and destruction. If profiling is disabled, this is just a relaxed load
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfilePoint point) : point(point)   {
+        if(ProfilingInternal::enabled.load(std::memory_order_relaxed))  {
+            start = std::chrono::steady_clock::now();
+            running = true;
+        }
+    }
+
+    ~ScopedTimer()  {
+        if(running) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            getHistogram(point).record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    ProfilePoint point;
+    bool running = false;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if AUTO_DEBRIS_PROFILING
+// Times the rest of the enclosing scope
+#define PROFILE_SCOPE(point) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(ProfilePoint::point)
+#else
+#define PROFILE_SCOPE(point)
+#endif
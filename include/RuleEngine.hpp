@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A condition as written in the config, before it is compiled
+struct ConditionDefinition {
+    std::string field; // One of "nps", "peakNps", "duration", "difficulty", "characteristic" or "pack"
+    std::string op; // One of "<", "<=", ">", ">=", "==" or "!="
+    std::string stringValue; // Used if the value in the config was a string
+    float numberValue = 0.0f; // Used if the value in the config was a number
+    bool isNumber = false;
+};
+
+// A rule as written in the config. The rule fires if all of its conditions are true
+struct RuleDefinition {
+    std::string name;
+    bool override; // Whether to override the setting if the rule fires. If false, the setting is never overridden
+    std::vector<ConditionDefinition> conditions;
+};
+
+enum class RuleField : uint8_t {
+    NPS,
+    PEAK_NPS,
+    DURATION,
+    DIFFICULTY,
+    CHARACTERISTIC,
+    PACK
+};
+
+// Everything that a rule can depend on. Fields that no rule uses don't need to be filled in
+struct RuleInputs {
+    float notesPerSecond;
+    float peakNotesPerSecond; // Negative if not known, in which case conditions on it are false
+    float duration;
+    int difficulty;
+    uint64_t characteristicHash;
+    // Hashes of the IDs and names of every pack the level is in. A pack condition matches if any of them are equal
+    const uint64_t* packHashes;
+    size_t packHashCount;
+};
+
+// Rules compiled into flat tables, so evaluating them is a loop over an array with no allocations or string comparisons
+class RuleSet {
+public:
+    // Compiles the rules, skipping any which are invalid and adding a message for each to errors
+    static RuleSet compile(const std::vector<RuleDefinition>& definitions, std::vector<std::string>& errors);
+
+    // Returns the index of the first rule which fires, or -1 if none do
+    int evaluate(const RuleInputs& inputs) const;
+
+    bool empty() const {return rules.empty();}
+    // Returns true if any rule has a condition on this field, so the caller knows which inputs it needs to find
+    bool usesField(RuleField field) const {return usedFields & (1u << (int) field);}
+
+    const std::string& getName(int rule) const {return names[rule];}
+    bool getOverride(int rule) const {return rules[rule].override;}
+    // The rules as written, including any invalid ones, so that they can be compiled again, e.g. when replaying a trace
+    const std::vector<RuleDefinition>& getDefinitions() const {return definitions;}
+
+private:
+    enum class Op : uint8_t {
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        EQUAL,
+        NOT_EQUAL
+    };
+
+    struct Condition {
+        RuleField field;
+        Op op;
+        float number; // Used for the numeric fields
+        uint64_t hash; // Used for the characteristic and pack fields
+    };
+
+    struct Rule {
+        uint32_t firstCondition;
+        uint32_t conditionCount;
+        bool override;
+    };
+
+    std::vector<Condition> conditions; // The conditions of every rule, one rule after another
+    std::vector<Rule> rules;
+    std::vector<std::string> names;
+    std::vector<RuleDefinition> definitions;
+    uint32_t usedFields = 0;
+
+    static bool compare(float value, float target, Op op);
+    static bool evaluateCondition(const Condition& condition, const RuleInputs& inputs);
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ConfigSnapshot.hpp"
+
+#include "GlobalNamespace/PlayerSpecificSettings.hpp"
+
+#include <optional>
+
+// Copies the player settings into a pooled copy, then changes reduce debris to the override mode and any other fields set in the config.
+// The same copy is reused for every level, so the returned settings are only valid until the next level starts.
+// If reduceDebris is given it is used instead of the override mode, e.g. when dynamic debris turns it on and off during the song.
+GlobalNamespace::PlayerSpecificSettings* overrideSettings(GlobalNamespace::PlayerSpecificSettings* settings, const ConfigSnapshot& config, std::optional<bool> reduceDebris = std::nullopt);
+
+// Finds the instance fields of the game's PlayerSpecificSettings for overrideSettings to copy, so that fields added by a game update are copied too.
+// Called at load so that any field which can't be copied is logged early, otherwise the first override finds them.
+void findSettingsFields();
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "ConfigSnapshot.hpp"
+#include "DecisionEngine.hpp"
+
+#include <cstdint>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Binary trace of the hook events in a menu session, which tools/replay replays against the decision engine.
+// The file is a header followed by events, each starting with its type and a timestamp in nanoseconds since recording started.
+// Values are written in native byte order, which is little endian on both the Quest and x86 Linux.
+namespace Trace {
+    constexpr uint32_t MAGIC = 0x52544441; // "ADTR"
+    // Version 2 added the measured performance input, and version 3 added the level overrides. Older traces can still be read
+    constexpr uint32_t VERSION = 3;
+
+    enum class EventType : uint8_t {
+        CONFIG = 1, // A config snapshot was published
+        SELECT, // A difficulty was selected
+        LEVEL_START, // A level was started, with the decision that was used
+        DECIDE, // The decision engine was run, with every input it asked for
+        CLEAR_DECISIONS // The decision cache was cleared, because the loaded packs changed
+    };
+
+    // The inputs to decision engine that were asked for in one decision
+    enum class Input : uint8_t {
+        NPS,
+        PEAK_NPS,
+        DURATION,
+        PACKS,
+        PERFORMANCE
+    };
+
+    struct Inputs {
+        uint8_t requested = 0; // Bit for each input the engine asked for
+        uint8_t available = 0; // Bit for each input the source could find
+        float notesPerSecond = 0.0f;
+        float peakNotesPerSecond = 0.0f;
+        float duration = 0.0f;
+        std::vector<LevelPack> packs;
+        MeasuredPerformance performance = MeasuredPerformance::UNKNOWN;
+
+        bool wasRequested(Input input) const {return requested & (1 << (int) input);}
+        bool wasAvailable(Input input) const {return available & (1 << (int) input);}
+    };
+
+    struct Event {
+        EventType type;
+        uint64_t timestamp;
+
+        DecisionKey key; // Used by SELECT, LEVEL_START and DECIDE
+        std::shared_ptr<const ConfigSnapshot> config; // Used by CONFIG
+
+        bool multiplayer = false; // Used by LEVEL_START
+        bool willOverride = false;
+
+        uint64_t configGeneration = 0; // Used by DECIDE
+        uint64_t latency = 0; // How long the decision took in game, in nanoseconds
+        Inputs inputs;
+        std::optional<Decision> decision; // Empty if the inputs weren't all available
+    };
+
+    // Records the inputs that another source provides to the decision engine
+    class RecordingInputSource : public DecisionInputSource {
+    public:
+        explicit RecordingInputSource(DecisionInputSource& inner) : inner(inner) {}
+
+        std::optional<float> calculateNotesPerSecond() override;
+        float calculatePeakNotesPerSecond() override;
+        std::optional<float> calculateDuration() override;
+        bool findLevelPacks(std::vector<LevelPack>& packs) override;
+        MeasuredPerformance findMeasuredPerformance() override;
+
+        const Inputs& getInputs() const {return inputs;}
+
+    private:
+        DecisionInputSource& inner;
+        Inputs inputs;
+    };
+
+    // Appends events to a trace file. Events are buffered, so they can be written from any thread without waiting on the file most of the time
+    class Writer {
+    public:
+        ~Writer();
+
+        bool open(const std::string& path);
+        bool isOpen() const {return file != nullptr;}
+        // True if writing to the file failed. The file is closed when this happens, and later events are ignored
+        bool failed() const {return writeFailed.load(std::memory_order_relaxed);}
+
+        void writeConfig(uint64_t timestamp, const ConfigSnapshot& config);
+        void writeSelect(uint64_t timestamp, const DecisionKey& key);
+        void writeLevelStart(uint64_t timestamp, const DecisionKey& key, bool multiplayer, bool willOverride);
+        void writeDecide(uint64_t timestamp, const DecisionKey& key, uint64_t configGeneration, uint64_t latency, const Inputs& inputs, const std::optional<Decision>& decision);
+        void writeClearDecisions(uint64_t timestamp);
+
+        // Writes the buffered events to the file
+        void flush();
+
+    private:
+        std::mutex mutex;
+        FILE* file = nullptr;
+        std::vector<uint8_t> buffer;
+        std::atomic<bool> writeFailed = false;
+
+        void flushLocked();
+        void finishEvent();
+    };
+
+    // Reads the events of a trace file one at a time
+    class Reader {
+    public:
+        // Returns false if the file couldn't be read or isn't a trace
+        bool open(const std::string& path);
+
+        // Reads the next event, returning false at the end of the trace or if the rest of the trace is invalid
+        bool next(Event& event);
+        // True if reading stopped because the trace was truncated or invalid, rather than at the end
+        bool failed() const {return invalid;}
+
+    private:
+        std::vector<uint8_t> data;
+        size_t position = 0;
+        uint32_t version = 0;
+        bool invalid = false;
+    };
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Trace.hpp"
+
+// Starts recording the hook events to a trace file in the data directory if "traceRecording" is enabled in the config.
+// Called from setup once the config has been loaded, so turning recording on or off takes effect after restarting the game.
+void startTraceRecording();
+
+// Each of these does nothing unless a trace is being recorded, which is one relaxed load
+bool isTraceRecording();
+void traceConfig(const ConfigSnapshot& config);
+void traceSelect(const DecisionKey& key);
+void traceLevelStart(const DecisionKey& key, bool multiplayer, bool willOverride);
+void traceDecide(const DecisionKey& key, uint64_t configGeneration, uint64_t latency, const Trace::Inputs& inputs, const std::optional<Decision>& decision);
+void traceClearDecisions();
@@ -9,22 +9,21 @@
 #include "GlobalNamespace/BeatmapLevelsModel.hpp"
 using namespace GlobalNamespace;
 
+#include "Config.hpp"
+
+const ModInfo& getModInfo();
 Configuration& getConfig();
 Logger& getLogger();
 
+// Gets the path of a file in the mod's data directory, creating the directory if it doesn't exist
+std::string getDataPath(std::string_view fileName);
+
 // Convenience method for finding the BeatmapLevelsModel if it hasn't been found already.
 BeatmapLevelsModel* getBeatmapLevelsModel();
 
-enum Mode   {
-    DISABLE = false,
-    ENABLE = true
-};
 // Converts a mode to a string
 std::string modeToString(Mode mode);
 
 Mode swapOverrideMode(); // Swaps the current override mode to the other value. Returns the new mode
 Mode getOverrideMode(); // Gets the current override mode
 
-// Convenience method for checking the rapidjson array for this playlist name, since there is no contains method
-bool isPlaylistOverridden(std::string name);
-
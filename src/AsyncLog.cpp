@@ -0,0 +1,72 @@
+#include "AsyncLog.hpp"
+#include "LogRing.hpp"
+#include "main.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+// Number of messages that can be waiting to be written. Must be a power of 2
+static constexpr size_t RING_CAPACITY = 256;
+// Longer messages are truncated
+static constexpr size_t MESSAGE_LENGTH = 240;
+// How long the log thread sleeps when there is nothing to write
+static constexpr std::chrono::milliseconds DRAIN_INTERVAL(20);
+
+std::atomic<LogSeverity> AsyncLogInternal::level = LogSeverity::INFO;
+
+static LogRing<RING_CAPACITY, MESSAGE_LENGTH> logRing;
+
+LogSeverity parseLogLevel(const char* name, LogSeverity defaultLevel)  {
+    static constexpr const char* LEVEL_NAMES[] = {"debug", "info", "warning", "error", "none"};
+    for(int i = 0; i <= (int) LogSeverity::NONE; i++)  {
+        if(strcmp(name, LEVEL_NAMES[i]) == 0)   {return (LogSeverity) i;}
+    }
+    return defaultLevel;
+}
+
+void setLogLevel(LogSeverity level)    {
+    AsyncLogInternal::level.store(level, std::memory_order_relaxed);
+}
+
+void logAsync(LogSeverity level, const char* format, ...)  {
+    va_list args;
+    va_start(args, format);
+    logRing.push(level, format, args);
+    va_end(args);
+}
+
+static void writeMessage(LogSeverity level, const char* text)  {
+    switch(level)   {
+        case LogSeverity::DEBUG:
+            getLogger().debug("%s", text);
+            break;
+        case LogSeverity::WARNING:
+            getLogger().warning("%s", text);
+            break;
+        case LogSeverity::ERROR:
+            getLogger().error("%s", text);
+            break;
+        default:
+            getLogger().info("%s", text);
+            break;
+    }
+}
+
+static void logWriterThread()   {
+    while(true) {
+        while(logRing.pop(writeMessage)) {}
+
+        uint64_t dropped = logRing.takeDropped();
+        if(dropped > 0) {
+            getLogger().warning("Log buffer was full, dropped %llu messages", (unsigned long long) dropped);
+        }
+
+        std::this_thread::sleep_for(DRAIN_INTERVAL);
+    }
+}
+
+void startLogWriter()   {
+    std::thread(logWriterThread).detach();
+}
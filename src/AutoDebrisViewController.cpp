@@ -1,4 +1,5 @@
 #include "AutoDebrisViewController.hpp"
+#include "Profiling.hpp"
 
 #include "questui/shared/BeatSaberUI.hpp"
 #include "questui/shared/CustomTypes/Components/Backgroundable.hpp"
@@ -9,6 +10,7 @@
 #include "UnityEngine/RectOffset.hpp"
 #include "UnityEngine/Events/UnityAction.hpp"
 #include "UnityEngine/GameObject.hpp"
+#include "UnityEngine/Color.hpp"
 
 #include "GlobalNamespace/IBeatmapLevelPack.hpp"
 #include "GlobalNamespace/IBeatmapLevelPackCollection.hpp"
@@ -16,6 +18,10 @@
 #include "TMPro/TextMeshProUGUI.hpp"
 using namespace TMPro;
 
+#include <algorithm>
+#include <cctype>
+#include <optional>
+
 using namespace AutoDebris;
 DEFINE_CLASS(AutoDebrisViewController);
 
@@ -33,7 +39,9 @@ void onThresholdToggleChange(AutoDebrisViewController* self, bool newValue) {
     if(!newValue)   {
         // Set the setting to -1 if the threshold was disabled
         getLogger().info("NPS threshold disabled: setting to -1.0");
-        getConfig().config["notesPerSecondThreshold"].SetDouble(-1.0);
+        editConfig([](ConfigSnapshot& config) {
+            config.notesPerSecondThreshold = -1.0f;
+        });
     }   else    {    
         // Set the setting back to a default of 5
         getLogger().info("NPS threshold enabled: setting to default");
@@ -44,30 +52,261 @@ void onThresholdToggleChange(AutoDebrisViewController* self, bool newValue) {
 
 // Set the NPS threshold in the config whenever the value changes
 void onThresholdSettingChange(float newValue)   {
-    getConfig().config["notesPerSecondThreshold"].SetDouble(newValue);
+    editConfig([newValue](ConfigSnapshot& config) {
+        config.notesPerSecondThreshold = newValue;
+    });
 }
 
-void onPlaylistSettingChange(Il2CppString* playlistName, bool newValue) {
-    auto& allocator = getConfig().config.GetAllocator();
+void onDensityModeToggleChange(bool newValue)  {
+    editConfig([newValue](ConfigSnapshot& config) {
+        config.densityMode = newValue ? DensityMode::PEAK : DensityMode::AVERAGE;
+    });
+}
 
-    // Convert the C# string into a rapidjson string value
-    rapidjson::Value playlistNameRapidjson;
-    playlistNameRapidjson.SetString(to_utf8(csstrtostr(playlistName)), allocator);
+void onDynamicDebrisToggleChange(bool newValue)  {
+    editConfig([newValue](ConfigSnapshot& config) {
+        config.dynamicDebris = newValue;
+    });
+}
 
-    // Get the array in the config that stores the playlists
-    rapidjson::GenericArray playlistsArray = getConfig().config["playlists"].GetArray();
-    if(newValue)   {
-        playlistsArray.PushBack(playlistNameRapidjson, allocator);
-    }   else    {
-        // Remove the playlist if it is in the overridden playlists array
-        for(auto iter = playlistsArray.Begin(); iter < playlistsArray.End(); iter++)    {
-            if(*iter == playlistNameRapidjson)  {
-                playlistsArray.Erase(iter);
-                break;
+void onAdaptiveModeToggleChange(bool newValue)  {
+    editConfig([newValue](ConfigSnapshot& config) {
+        config.adaptiveMode = newValue;
+    });
+}
+
+// Number of playlists shown on each page of the playlist settings
+static constexpr int PLAYLIST_COLUMNS = 4;
+static constexpr int PLAYLISTS_PER_PAGE = PLAYLIST_COLUMNS * 6;
+
+// Bits of PlaylistEntry::state
+static constexpr uint8_t PLAYLIST_SELECTED = 1; // The playlist is checked
+static constexpr uint8_t PLAYLIST_CHANGED = 2; // The playlist was toggled since the selection was last published to the config
+
+// A loaded playlist. The strings are made once when the list is built, so binding the cells and toggling a playlist don't make them again
+struct PlaylistEntry {
+    // Shared with the playlist index when the playlist is overridden, rather than copied into it
+    std::shared_ptr<const std::string> id;
+    std::shared_ptr<const std::string> name;
+    std::string lowerCaseName; // Used for case insensitive searching
+    Il2CppString* displayName; // The pack's own name string, which is shown in the cells
+    uint32_t displayNameHandle; // Keeps the name alive even if the packs are reloaded while the list is open
+    uint8_t state; // PLAYLIST_ bits. Toggling only changes these, and the config is updated when the menu closes
+};
+
+// One of the toggles in the playlist grid, which shows a different playlist depending on the page and search
+struct PlaylistCell {
+    UnityEngine::GameObject* row;
+    UnityEngine::UI::Toggle* toggle;
+    TextMeshProUGUI* text;
+};
+
+static struct {
+    std::vector<PlaylistEntry> entries;
+    std::vector<size_t> filtered; // Indices of the entries that match the search
+    std::string search;
+    size_t page = 0;
+
+    PlaylistCell cells[PLAYLISTS_PER_PAGE];
+    TextMeshProUGUI* pageText;
+    bool bindingCells = false; // Set while the toggles are being updated, so that their callbacks are ignored
+    bool selectionChanged = false; // Set if any entry has PLAYLIST_CHANGED
+} playlistList;
+
+static std::string toLowerCase(std::string_view str)    {
+    std::string result(str);
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {return std::tolower(c);});
+    return result;
+}
+
+static size_t getPlaylistPageCount()    {
+    return std::max<size_t>(1, (playlistList.filtered.size() + PLAYLISTS_PER_PAGE - 1) / PLAYLISTS_PER_PAGE);
+}
+
+// Matches a playlist against patterns the same way as the decision engine does, by either its ID or name
+static bool matchesPlaylistPattern(const PackMatcher& matcher, const PlaylistEntry& entry)   {
+    return (!entry.id->empty() && matcher.matches(*entry.id)) || (!entry.name->empty() && matcher.matches(*entry.name));
+}
+
+// Name colour of playlists that are only overridden because a pattern matches them
+static const UnityEngine::Color PATTERN_MATCHED_COLOR(0.55f, 0.8f, 1.0f, 1.0f);
+
+static void bindPlaylistCell(PlaylistCell& cell, const PlaylistEntry& entry, const ConfigSnapshot& config)   {
+    bool selected = entry.state & PLAYLIST_SELECTED;
+    bool patternMatched = !selected && matchesPlaylistPattern(*config.playlistPatterns, entry);
+
+    playlistList.bindingCells = true;
+    cell.toggle->set_isOn(selected || patternMatched);
+    playlistList.bindingCells = false;
+    // Unchecking a playlist can't stop a pattern from matching it, so lock it and tint its name instead. Patterns are removed with "None"
+    cell.toggle->set_interactable(!patternMatched);
+    cell.text->set_color(patternMatched ? PATTERN_MATCHED_COLOR : UnityEngine::Color::get_white());
+}
+
+// Updates the toggles to show the playlists on the current page
+static void bindPlaylistCells() {
+    std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+    size_t pageStart = playlistList.page * PLAYLISTS_PER_PAGE;
+
+    for(size_t i = 0; i < PLAYLISTS_PER_PAGE; i++)  {
+        PlaylistCell& cell = playlistList.cells[i];
+        if(pageStart + i >= playlistList.filtered.size())   {
+            cell.row->SetActive(false);
+            continue;
+        }
+
+        const PlaylistEntry& entry = playlistList.entries[playlistList.filtered[pageStart + i]];
+        cell.row->SetActive(true);
+        cell.text->SetText(entry.displayName);
+        bindPlaylistCell(cell, entry, *config);
+    }
+
+    std::string pageText = std::to_string(playlistList.page + 1) + "/" + std::to_string(getPlaylistPageCount());
+    playlistList.pageText->SetText(il2cpp_utils::createcsstr(pageText));
+}
+
+// Finds the playlists which match the current search, then goes back to the first page.
+// If the search has wildcards it is matched as a pattern against the whole ID or name, like the saved patterns are. Otherwise any name containing it matches
+static void filterPlaylists()   {
+    std::optional<PackMatcher> searchPattern;
+    if(PackMatcher::isPattern(playlistList.search)) {
+        std::vector<std::string> errors;
+        searchPattern = PackMatcher::compile({playlistList.search}, errors);
+    }
+
+    playlistList.filtered.clear();
+    for(size_t i = 0; i < playlistList.entries.size(); i++) {
+        const PlaylistEntry& entry = playlistList.entries[i];
+        bool matches = searchPattern ? matchesPlaylistPattern(*searchPattern, entry) : entry.lowerCaseName.find(playlistList.search) != std::string::npos;
+        if(matches)  {
+            playlistList.filtered.push_back(i);
+        }
+    }
+
+    playlistList.page = 0;
+    bindPlaylistCells();
+}
+
+// Applies the playlists toggled since the last publish to the config, in one edit.
+// Toggling a cell only changes the entry's bits, so clicking through many playlists doesn't copy the playlist set each time
+static void publishPlaylistSelection()  {
+    if(!playlistList.selectionChanged)  {return;}
+    playlistList.selectionChanged = false;
+
+    editPlaylists([](PlaylistIndex& playlists) {
+        for(PlaylistEntry& entry : playlistList.entries)    {
+            if(!(entry.state & PLAYLIST_CHANGED))   {continue;}
+            entry.state &= ~PLAYLIST_CHANGED;
+
+            if(entry.state & PLAYLIST_SELECTED) {
+                playlists.insert(entry.id, entry.name);
+            }   else    {
+                // Remove the playlist under both its ID and name, since older configs only stored the name
+                playlists.erase(*entry.id, *entry.name);
             }
         }
+    });
+}
+
+// Finds the names and IDs of all of the loaded playlists
+static void loadPlaylistEntries()   {
+    publishPlaylistSelection();
+    for(const PlaylistEntry& entry : playlistList.entries)  {
+        il2cpp_functions::gchandle_free(entry.displayNameHandle);
+    }
+    playlistList.entries.clear();
+
+    std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+    Array<IBeatmapLevelPack*>* loadedPlaylists = getBeatmapLevelsModel()->get_allLoadedBeatmapLevelPackCollection()->get_beatmapLevelPacks();
+    playlistList.entries.reserve(loadedPlaylists->Length());
+    for(int i = 0; i < loadedPlaylists->Length(); i++)  {
+        IBeatmapLevelPack* playlist = loadedPlaylists->values[i];
+        Il2CppString* displayName = playlist->get_packName();
+        std::string playlistName = to_utf8(csstrtostr(displayName));
+        std::string lowerCaseName = toLowerCase(playlistName);
+        std::string playlistId = to_utf8(csstrtostr(playlist->get_packID()));
+        uint8_t state = config->playlists->contains(playlistId, playlistName) ? PLAYLIST_SELECTED : 0;
+        playlistList.entries.push_back(PlaylistEntry {
+            std::make_shared<const std::string>(std::move(playlistId)),
+            std::make_shared<const std::string>(std::move(playlistName)),
+            std::move(lowerCaseName),
+            displayName,
+            il2cpp_functions::gchandle_new(reinterpret_cast<Il2CppObject*>(displayName), false),
+            state
+        });
+    }
+
+    filterPlaylists();
+}
+
+void onPlaylistSearchChange(const std::string& newValue)    {
+    playlistList.search = toLowerCase(newValue);
+    filterPlaylists();
+}
+
+void changePlaylistPage(int offset) {
+    size_t pageCount = getPlaylistPageCount();
+    playlistList.page = (playlistList.page + pageCount + offset) % pageCount;
+    bindPlaylistCells();
+}
+
+// Overrides every loaded playlist. Like toggling, this is published when the menu closes
+void onSelectAllPlaylists() {
+    for(PlaylistEntry& entry : playlistList.entries)    {
+        entry.state = PLAYLIST_SELECTED | PLAYLIST_CHANGED;
+    }
+    playlistList.selectionChanged = true;
+    bindPlaylistCells();
+}
+
+// Stops overriding any playlist, including the ones matched by patterns
+void onSelectNoPlaylists()  {
+    editConfig([](ConfigSnapshot& config) {
+        config.playlists = std::make_shared<const PlaylistIndex>();
+        config.playlistPatterns = std::make_shared<const PackMatcher>();
+    });
+    // Toggles that haven't been published yet are dropped too
+    for(PlaylistEntry& entry : playlistList.entries)    {
+        entry.state = 0;
+    }
+    playlistList.selectionChanged = false;
+    bindPlaylistCells();
+}
+
+// Overrides the playlists matching the search. A search with wildcards is saved as a pattern, so it also matches playlists added later
+void onSelectMatchingPlaylists()    {
+    if(playlistList.search.empty()) {return;}
+
+    if(PackMatcher::isPattern(playlistList.search)) {
+        std::vector<std::string> patterns = getConfigSnapshot()->playlistPatterns->getPatterns();
+        if(std::find(patterns.begin(), patterns.end(), playlistList.search) == patterns.end())  {
+            patterns.push_back(playlistList.search);
+        }
+        std::shared_ptr<const PackMatcher> matcher = compilePlaylistPatterns(patterns);
+
+        editConfig([&matcher](ConfigSnapshot& config) {
+            config.playlistPatterns = std::move(matcher);
+        });
+    }   else    {
+        for(size_t index : playlistList.filtered)   {
+            playlistList.entries[index].state = PLAYLIST_SELECTED | PLAYLIST_CHANGED;
+        }
+        playlistList.selectionChanged = true;
     }
-    
+    bindPlaylistCells();
+}
+
+void onPlaylistCellToggled(int cellIndex, bool newValue)    {
+    if(playlistList.bindingCells)   {return;}
+
+    size_t filteredIndex = playlistList.page * PLAYLISTS_PER_PAGE + cellIndex;
+    if(filteredIndex >= playlistList.filtered.size())   {return;}
+
+    // Nothing is allocated here. The selection is published to the config in one edit when the menu closes
+    PlaylistEntry& entry = playlistList.entries[playlistList.filtered[filteredIndex]];
+    entry.state = (newValue ? PLAYLIST_SELECTED : 0) | PLAYLIST_CHANGED;
+    playlistList.selectionChanged = true;
+    bindPlaylistCell(playlistList.cells[cellIndex], entry, *getConfigSnapshot());
 }
 
 void AutoDebrisViewController::DidActivate(bool firstActivation, bool addedToHierarchy, bool screenSystemEnabling)  {
@@ -104,53 +343,87 @@ void AutoDebrisViewController::DidActivate(bool firstActivation, bool addedToHie
         thresholdLayout->set_childAlignment(UnityEngine::TextAnchor::UpperCenter);
 
 
-        double currentThresholdValue = getConfig().config["notesPerSecondThreshold"].GetDouble();
+        double currentThresholdValue = getConfigSnapshot()->notesPerSecondThreshold;
         QuestUI::BeatSaberUI::CreateToggle(thresholdLayout->get_rectTransform(), "Enable NPS threshold", true, [this](bool newValue) {onThresholdToggleChange(this, newValue);});
         this->thresholdSetting = QuestUI::BeatSaberUI::CreateIncrementSetting(thresholdLayout->get_rectTransform(), "", 1, 0.5, currentThresholdValue, onThresholdSettingChange);
         // Call the threshold toggle change function to hide the setting if neceessary
         onThresholdToggleChange(this, currentThresholdValue != -1.0);
 
+        // Toggle for comparing the threshold against the densest part of the song instead of the average
+        UnityEngine::UI::Toggle* densityToggle = QuestUI::BeatSaberUI::CreateToggle(mainLayout->get_rectTransform(), "Use peak density", getConfigSnapshot()->densityMode == DensityMode::PEAK, onDensityModeToggleChange);
+        QuestUI::BeatSaberUI::AddHoverHint(densityToggle->get_gameObject(), "Compares the threshold against the NPS of the densest parts of the song, rather than the average NPS. Songs are analyzed in the background after they are loaded.");
+
+        // Toggle for only reducing debris in the parts of the song above the threshold
+        UnityEngine::UI::Toggle* dynamicDebrisToggle = QuestUI::BeatSaberUI::CreateToggle(mainLayout->get_rectTransform(), "Dynamic debris", getConfigSnapshot()->dynamicDebris, onDynamicDebrisToggleChange);
+        QuestUI::BeatSaberUI::AddHoverHint(dynamicDebrisToggle->get_gameObject(), "When enabling reduce debris on a custom song, only reduces debris during the parts of the song above the NPS threshold.");
+
+        // Toggle for deciding from the frame times measured while playing, rather than the NPS
+        UnityEngine::UI::Toggle* adaptiveToggle = QuestUI::BeatSaberUI::CreateToggle(mainLayout->get_rectTransform(), "Adaptive mode", getConfigSnapshot()->adaptiveMode, onAdaptiveModeToggleChange);
+        QuestUI::BeatSaberUI::AddHoverHint(adaptiveToggle->get_gameObject(), "Measures the frame rate while playing. Difficulties that dropped frames are overridden the next time they are played, instead of using the NPS threshold.");
+
         // Add a hover hint for the playlist settings
         UnityEngine::UI::VerticalLayoutGroup* playlistsSectionLayout = QuestUI::BeatSaberUI::CreateVerticalLayoutGroup(mainLayout->get_rectTransform());
         QuestUI::BeatSaberUI::CreateText(playlistsSectionLayout->get_rectTransform(), "Playlist Settings");
-        QuestUI::BeatSaberUI::AddHoverHint(playlistsSectionLayout->get_gameObject(), "Select playlists where the debris setting will always be overridden.");
+        QuestUI::BeatSaberUI::AddHoverHint(playlistsSectionLayout->get_gameObject(), "Select playlists where the debris setting will always be overridden. Playlists shown in blue are matched by a pattern, and can only be turned off by removing the pattern.");
         playlistsSectionLayout->get_gameObject()->AddComponent<QuestUI::Backgroundable*>()->ApplyBackground(il2cpp_utils::createcsstr("round-rect-panel"));
         playlistsSectionLayout->set_padding(UnityEngine::RectOffset::New_ctor(2, 2, 2, 2));
 
+        // Search box for filtering the playlists by name
+        QuestUI::BeatSaberUI::CreateStringSetting(playlistsSectionLayout->get_rectTransform(), "Search", "", [](std::string newValue) {onPlaylistSearchChange(newValue);});
+
+        // Buttons for changing many playlists at once
+        UnityEngine::UI::HorizontalLayoutGroup* bulkLayout = QuestUI::BeatSaberUI::CreateHorizontalLayoutGroup(playlistsSectionLayout->get_rectTransform());
+        bulkLayout->set_childAlignment(UnityEngine::TextAnchor::MiddleCenter);
+        QuestUI::BeatSaberUI::CreateUIButton(bulkLayout->get_rectTransform(), "All", onSelectAllPlaylists);
+        QuestUI::BeatSaberUI::CreateUIButton(bulkLayout->get_rectTransform(), "None", onSelectNoPlaylists);
+        UnityEngine::UI::Button* matchingButton = QuestUI::BeatSaberUI::CreateUIButton(bulkLayout->get_rectTransform(), "Matching", onSelectMatchingPlaylists);
+        QuestUI::BeatSaberUI::AddHoverHint(matchingButton->get_gameObject(), "Overrides the playlists matching the search. Searches containing * or ? are saved as patterns, so they also apply to playlists added later.");
+
         // Layout for the buttons to enable/disable the override on specific playlists
         // This is a grid, since one vertical list doesn't allow for enough room
         UnityEngine::UI::GridLayoutGroup* playlistsLayout = QuestUI::BeatSaberUI::CreateGridLayoutGroup(playlistsSectionLayout->get_rectTransform());
         playlistsLayout->set_constraint(UnityEngine::UI::GridLayoutGroup::Constraint::FixedColumnCount);
-        playlistsLayout->set_constraintCount(4);
+        playlistsLayout->set_constraintCount(PLAYLIST_COLUMNS);
         playlistsLayout->set_cellSize(UnityEngine::Vector2(40.0f, 6.0f));
         playlistsLayout->set_spacing(UnityEngine::Vector2(1.0f, 0.8f));
 
-        // Find all the loaded playlists
-        Array<IBeatmapLevelPack*>* loadedPlaylists = getBeatmapLevelsModel()->get_allLoadedBeatmapLevelPackCollection()->get_beatmapLevelPacks();
-        for(int i = 0; i < loadedPlaylists->Length(); i++)  {
-            IBeatmapLevelPack* playlist = loadedPlaylists->values[i];
-            std::string playlistName = to_utf8(csstrtostr(playlist->get_packName()));
-
-            const int MAX_LENGTH = 1000000;
-            if(playlistName.length() > MAX_LENGTH) {
-                playlistName = playlistName.substr(0, MAX_LENGTH - 3) + "...";
-            }
-
+        // Only create enough toggles for one page. These are reused for every page, rather than creating one per playlist
+        for(int i = 0; i < PLAYLISTS_PER_PAGE; i++)  {
+            PlaylistCell& cell = playlistList.cells[i];
             UnityEngine::UI::HorizontalLayoutGroup* playlistRow = QuestUI::BeatSaberUI::CreateHorizontalLayoutGroup(playlistsLayout->get_rectTransform());
-            // Create the toggle, setting the current value to whether or not the playlist is overridden
-            UnityEngine::UI::Toggle* toggle = QuestUI::BeatSaberUI::CreateToggle(playlistRow->get_rectTransform(), playlistName, isPlaylistOverridden(playlistName),
-                [playlistName] (bool newValue) {onPlaylistSettingChange(il2cpp_utils::createcsstr(playlistName), newValue);}
-            );
-
-            UnityEngine::Transform* toggleParentTransform = toggle->get_transform()->GetParent();
-            TextMeshProUGUI* toggleText = toggleParentTransform->get_gameObject()->GetComponentInChildren<TextMeshProUGUI*>();
-            toggleText->set_overflowMode(TextOverflowModes::Ellipsis);
-            toggleText->set_fontSize(2.5);
+            cell.row = playlistRow->get_gameObject();
+            cell.toggle = QuestUI::BeatSaberUI::CreateToggle(playlistRow->get_rectTransform(), "", false, [i] (bool newValue) {onPlaylistCellToggled(i, newValue);});
+
+            UnityEngine::Transform* toggleParentTransform = cell.toggle->get_transform()->GetParent();
+            cell.text = toggleParentTransform->get_gameObject()->GetComponentInChildren<TextMeshProUGUI*>();
+            cell.text->set_overflowMode(TextOverflowModes::Ellipsis);
+            cell.text->set_fontSize(2.5);
         }
+
+        // Buttons for switching between pages
+        UnityEngine::UI::HorizontalLayoutGroup* pageLayout = QuestUI::BeatSaberUI::CreateHorizontalLayoutGroup(playlistsSectionLayout->get_rectTransform());
+        pageLayout->set_childAlignment(UnityEngine::TextAnchor::MiddleCenter);
+        QuestUI::BeatSaberUI::CreateUIButton(pageLayout->get_rectTransform(), "<", [] {changePlaylistPage(-1);});
+        playlistList.pageText = QuestUI::BeatSaberUI::CreateText(pageLayout->get_rectTransform(), "");
+        QuestUI::BeatSaberUI::CreateUIButton(pageLayout->get_rectTransform(), ">", [] {changePlaylistPage(1);});
+    }
+
+    // The loaded packs may have changed since the menu was last opened
+    if(playlistList.pageText)   {
+        loadPlaylistEntries();
     }
 }
 
-// Save the config upon closing the menu
+// Publish the playlist toggles and save the config upon closing the menu, rather than waiting for the background writer
 void AutoDebrisViewController::DidDeactivate(bool removedFromHierarchy, bool systemScreenDisabling)  {
-    getConfig().Write();
+    publishPlaylistSelection();
+    flushConfig();
+
+    // Write out the hook timings if they're enabled
+    if(getConfigSnapshot()->profiling)  {
+        std::string path = getDataPath("latency.txt");
+        if(writeProfilingSummary(path)) {
+            getLogger().info("Wrote hook latency summary to %s", path.c_str());
+        }
+    }
 }
\ No newline at end of file
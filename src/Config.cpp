@@ -0,0 +1,400 @@
+#include "Config.hpp"
+#include "main.hpp"
+#include "Profiling.hpp"
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <sys/stat.h>
+
+// How long the config needs to stay unchanged before the writer flushes it to disk
+static constexpr std::chrono::milliseconds WRITE_DEBOUNCE(750);
+// How often the config file is checked for edits made outside of the game
+static constexpr std::chrono::seconds WATCH_INTERVAL(2);
+
+static std::shared_ptr<const ConfigSnapshot> currentSnapshot = std::make_shared<const ConfigSnapshot>();
+
+// Guards the rapidjson document, as well as the writer state below
+static std::mutex configMutex;
+static std::condition_variable configChanged;
+static bool configDirty = false;
+static std::chrono::steady_clock::time_point lastEditTime;
+// Identifies a version of the config file on disk. The size is compared too, in case the file system only has coarse modification times
+struct ConfigFileVersion {
+    int64_t modifySeconds = 0;
+    int64_t modifyNanoseconds = 0;
+    int64_t size = 0;
+
+    bool operator==(const ConfigFileVersion& other) const {
+        return modifySeconds == other.modifySeconds && modifyNanoseconds == other.modifyNanoseconds && size == other.size;
+    }
+};
+
+static ConfigFileVersion lastWriteVersion; // Version of the config file when we last read or wrote it
+static std::shared_ptr<const LevelOverrideList> writtenLevelOverrides; // The level overrides that are saved on disk
+
+static ConfigFileVersion getConfigFileVersion()  {
+    struct stat fileInfo;
+    if(stat(getConfigFilePath(getModInfo()).c_str(), &fileInfo) != 0)  {
+        return ConfigFileVersion();
+    }
+    // Nanoseconds, so that an edit within the same second as our last write is still noticed
+    return ConfigFileVersion {fileInfo.st_mtim.tv_sec, fileInfo.st_mtim.tv_nsec, fileInfo.st_size};
+}
+
+static void createDefaultConfig()  {
+    ConfigDocument& config = getConfig().config;
+    // Find if the config has been created
+    if(config.HasMember("mode")) {return;}
+
+    // Add all the default options
+    auto& alloc = config.GetAllocator();
+    config.AddMember("mode", "disable", alloc);
+    config.AddMember("notesPerSecondThreshold", 5.0, alloc);
+    config.AddMember("densityMode", "average", alloc);
+    config.AddMember("densityWindow", 2.0, alloc);
+    config.AddMember("densityPercentile", 0.9, alloc);
+    config.AddMember("dynamicDebris", false, alloc);
+    config.AddMember("dynamicDebrisLeadTime", 1.0, alloc);
+    config.AddMember("dynamicDebrisHysteresis", 0.8, alloc);
+    config.AddMember("adaptiveMode", false, alloc);
+    config.AddMember("frameTimePercentile", 0.95, alloc);
+    config.AddMember("frameTimeBudget", 0.0, alloc);
+    config.AddMember("playlists", rapidjson::Value(rapidjson::kArrayType), alloc);
+    config.AddMember("playlistIds", rapidjson::Value(rapidjson::kArrayType), alloc);
+    config.AddMember("playlistPatterns", rapidjson::Value(rapidjson::kArrayType), alloc);
+    config.AddMember("rules", rapidjson::Value(rapidjson::kArrayType), alloc);
+    config.AddMember("overrideFields", rapidjson::Value(rapidjson::kObjectType), alloc);
+    config.AddMember("profiling", false, alloc);
+    config.AddMember("logLevel", "info", alloc);
+    config.AddMember("traceRecording", false, alloc);
+
+    getConfig().Write(); // Write the config back to disk
+}
+
+// Reads the rules in the config, then compiles them. Rules are only edited in the config file, so they are never written back
+static std::shared_ptr<const RuleSet> readRules(rapidjson::Value& rulesArray)  {
+    std::vector<RuleDefinition> definitions;
+    for(rapidjson::Value& ruleValue : rulesArray.GetArray())   {
+        if(!ruleValue.IsObject())   {continue;}
+
+        RuleDefinition definition;
+        definition.name = ruleValue.HasMember("name") && ruleValue["name"].IsString() ? ruleValue["name"].GetString() : "Rule " + std::to_string(definitions.size() + 1);
+        definition.override = !ruleValue.HasMember("override") || !ruleValue["override"].IsBool() || ruleValue["override"].GetBool();
+
+        if(ruleValue.HasMember("conditions") && ruleValue["conditions"].IsArray())  {
+            for(rapidjson::Value& conditionValue : ruleValue["conditions"].GetArray())  {
+                if(!conditionValue.IsObject() || !conditionValue.HasMember("field") || !conditionValue.HasMember("op") || !conditionValue.HasMember("value"))    {
+                    continue;
+                }
+
+                ConditionDefinition condition;
+                condition.field = conditionValue["field"].IsString() ? conditionValue["field"].GetString() : "";
+                condition.op = conditionValue["op"].IsString() ? conditionValue["op"].GetString() : "";
+                rapidjson::Value& value = conditionValue["value"];
+                if(value.IsNumber())    {
+                    condition.isNumber = true;
+                    condition.numberValue = value.GetFloat();
+                }   else if(value.IsString())   {
+                    condition.stringValue = value.GetString();
+                }
+                definition.conditions.push_back(std::move(condition));
+            }
+        }
+        definitions.push_back(std::move(definition));
+    }
+
+    std::vector<std::string> errors;
+    std::shared_ptr<const RuleSet> rules = std::make_shared<const RuleSet>(RuleSet::compile(definitions, errors));
+    for(const std::string& error : errors)  {
+        getLogger().error("Invalid rule: %s", error.c_str());
+    }
+    return rules;
+}
+
+// Reads the playlist patterns in the config, then compiles them into one matcher
+static std::shared_ptr<const PackMatcher> readPlaylistPatterns(rapidjson::Value& patternsArray)  {
+    std::vector<std::string> patterns;
+    for(rapidjson::Value& value : patternsArray.GetArray()) {
+        if(value.IsString())    {
+            patterns.emplace_back(value.GetString(), value.GetStringLength());
+        }
+    }
+    return compilePlaylistPatterns(patterns);
+}
+
+// Reads the extra settings to override, e.g. {"saberTrailIntensity": 0, "noTextsAndHuds": true}
+static OverrideSet readOverrideFields(rapidjson::Value& fieldsObject)    {
+    OverrideSet overrides;
+    for(auto& member : fieldsObject.GetObject())  {
+        std::string_view name(member.name.GetString(), member.name.GetStringLength());
+        std::optional<OverrideField> field = parseOverrideField(name);
+        if(!field || *field == OverrideField::REDUCE_DEBRIS)  {
+            getLogger().error("Invalid override field: %s", member.name.GetString());
+            continue;
+        }
+
+        if(member.value.IsBool())   {
+            overrides.set(*field, member.value.GetBool() ? 1.0f : 0.0f);
+        }   else if(member.value.IsNumber())  {
+            overrides.set(*field, member.value.GetFloat());
+        }
+    }
+    return overrides;
+}
+
+// Reads the values from the rapidjson document into a new snapshot, using the defaults for anything missing
+static std::shared_ptr<ConfigSnapshot> readSnapshot(ConfigDocument& config) {
+    std::shared_ptr<ConfigSnapshot> snapshot = std::make_shared<ConfigSnapshot>();
+
+    if(config.HasMember("mode") && config["mode"].IsString())   {
+        snapshot->mode = std::string(config["mode"].GetString()) == "enable" ? ENABLE : DISABLE;
+    }
+    if(config.HasMember("notesPerSecondThreshold") && config["notesPerSecondThreshold"].IsNumber())    {
+        snapshot->notesPerSecondThreshold = config["notesPerSecondThreshold"].GetFloat();
+    }
+    if(config.HasMember("densityMode") && config["densityMode"].IsString())   {
+        snapshot->densityMode = std::string(config["densityMode"].GetString()) == "peak" ? DensityMode::PEAK : DensityMode::AVERAGE;
+    }
+    if(config.HasMember("densityWindow") && config["densityWindow"].IsNumber() && config["densityWindow"].GetFloat() > 0)    {
+        snapshot->densityWindow = config["densityWindow"].GetFloat();
+    }
+    if(config.HasMember("densityPercentile") && config["densityPercentile"].IsNumber())    {
+        snapshot->densityPercentile = config["densityPercentile"].GetFloat();
+    }
+    if(config.HasMember("dynamicDebris") && config["dynamicDebris"].IsBool())   {
+        snapshot->dynamicDebris = config["dynamicDebris"].GetBool();
+    }
+    if(config.HasMember("dynamicDebrisLeadTime") && config["dynamicDebrisLeadTime"].IsNumber() && config["dynamicDebrisLeadTime"].GetFloat() >= 0)    {
+        snapshot->dynamicDebrisLeadTime = config["dynamicDebrisLeadTime"].GetFloat();
+    }
+    if(config.HasMember("dynamicDebrisHysteresis") && config["dynamicDebrisHysteresis"].IsNumber())    {
+        snapshot->dynamicDebrisHysteresis = std::clamp(config["dynamicDebrisHysteresis"].GetFloat(), 0.0f, 1.0f);
+    }
+    if(config.HasMember("adaptiveMode") && config["adaptiveMode"].IsBool())   {
+        snapshot->adaptiveMode = config["adaptiveMode"].GetBool();
+    }
+    if(config.HasMember("frameTimePercentile") && config["frameTimePercentile"].IsNumber())    {
+        snapshot->frameTimePercentile = std::clamp(config["frameTimePercentile"].GetFloat(), 0.0f, 1.0f);
+    }
+    if(config.HasMember("frameTimeBudget") && config["frameTimeBudget"].IsNumber() && config["frameTimeBudget"].GetFloat() >= 0)    {
+        snapshot->frameTimeBudget = config["frameTimeBudget"].GetFloat();
+    }
+    if(config.HasMember("profiling") && config["profiling"].IsBool())   {
+        snapshot->profiling = config["profiling"].GetBool();
+    }
+    if(config.HasMember("traceRecording") && config["traceRecording"].IsBool())   {
+        snapshot->traceRecording = config["traceRecording"].GetBool();
+    }
+    if(config.HasMember("logLevel") && config["logLevel"].IsString())   {
+        snapshot->logLevel = parseLogLevel(config["logLevel"].GetString(), LogSeverity::INFO);
+    }
+    if(config.HasMember("rules") && config["rules"].IsArray())  {
+        snapshot->rules = readRules(config["rules"]);
+    }
+    if(config.HasMember("playlistPatterns") && config["playlistPatterns"].IsArray())  {
+        snapshot->playlistPatterns = readPlaylistPatterns(config["playlistPatterns"]);
+    }
+    if(config.HasMember("overrideFields") && config["overrideFields"].IsObject())  {
+        snapshot->overrideFields = readOverrideFields(config["overrideFields"]);
+    }
+    // Older configs only store playlist names, so the IDs array may not exist
+    std::shared_ptr<PlaylistIndex> playlists = std::make_shared<PlaylistIndex>();
+    if(config.HasMember("playlists") && config["playlists"].IsArray())  {
+        for(rapidjson::Value& value : config["playlists"].GetArray())   {
+            if(value.IsString())    {
+                playlists->insert("", std::string_view(value.GetString(), value.GetStringLength()));
+            }
+        }
+    }
+    if(config.HasMember("playlistIds") && config["playlistIds"].IsArray())  {
+        for(rapidjson::Value& value : config["playlistIds"].GetArray())   {
+            if(value.IsString())    {
+                playlists->insert(std::string_view(value.GetString(), value.GetStringLength()), "");
+            }
+        }
+    }
+    snapshot->playlists = std::move(playlists);
+
+    return snapshot;
+}
+
+// Sets a member of the document, adding it if it doesn't exist yet
+static void setMember(ConfigDocument& config, const char* name, rapidjson::Value value)  {
+    auto& alloc = config.GetAllocator();
+    if(config.HasMember(name))  {
+        config[name] = value;
+    }   else    {
+        config.AddMember(rapidjson::StringRef(name), value, alloc);
+    }
+}
+
+// Copies the values in the snapshot back into the rapidjson document. Any other members in the document are left alone
+static void writeSnapshot(const ConfigSnapshot& snapshot, ConfigDocument& config)  {
+    auto& alloc = config.GetAllocator();
+    setMember(config, "mode", rapidjson::Value(modeToString(snapshot.mode).c_str(), alloc));
+    setMember(config, "notesPerSecondThreshold", rapidjson::Value((double) snapshot.notesPerSecondThreshold));
+    setMember(config, "densityMode", rapidjson::Value(rapidjson::StringRef(snapshot.densityMode == DensityMode::PEAK ? "peak" : "average")));
+    setMember(config, "densityWindow", rapidjson::Value((double) snapshot.densityWindow));
+    setMember(config, "densityPercentile", rapidjson::Value((double) snapshot.densityPercentile));
+    setMember(config, "dynamicDebris", rapidjson::Value(snapshot.dynamicDebris));
+    setMember(config, "adaptiveMode", rapidjson::Value(snapshot.adaptiveMode));
+
+    rapidjson::Value playlistsArray(rapidjson::kArrayType);
+    snapshot.playlists->forEachName([&](std::string_view name) {
+        playlistsArray.PushBack(rapidjson::Value(name.data(), name.length(), alloc), alloc);
+    });
+    setMember(config, "playlists", std::move(playlistsArray));
+
+    rapidjson::Value playlistIdsArray(rapidjson::kArrayType);
+    snapshot.playlists->forEachId([&](std::string_view id) {
+        playlistIdsArray.PushBack(rapidjson::Value(id.data(), id.length(), alloc), alloc);
+    });
+    setMember(config, "playlistIds", std::move(playlistIdsArray));
+
+    rapidjson::Value playlistPatternsArray(rapidjson::kArrayType);
+    for(const std::string& pattern : snapshot.playlistPatterns->getPatterns()) {
+        playlistPatternsArray.PushBack(rapidjson::Value(pattern.c_str(), pattern.length(), alloc), alloc);
+    }
+    setMember(config, "playlistPatterns", std::move(playlistPatternsArray));
+}
+
+std::shared_ptr<const PackMatcher> compilePlaylistPatterns(const std::vector<std::string>& patterns)  {
+    std::vector<std::string> errors;
+    std::shared_ptr<const PackMatcher> matcher = std::make_shared<const PackMatcher>(PackMatcher::compile(patterns, errors));
+    for(const std::string& error : errors)  {
+        getLogger().error("%s", error.c_str());
+    }
+    return matcher;
+}
+
+static std::string getLevelOverridesPath()   {
+    return getDataPath("level-overrides.bin");
+}
+
+std::shared_ptr<const ConfigSnapshot> getConfigSnapshot()   {
+    return std::atomic_load(&currentSnapshot);
+}
+
+// Must be called with configMutex held, so that generations are never reused
+static void publishSnapshot(std::shared_ptr<ConfigSnapshot> snapshot)   {
+    // Only a change to what the decision engine reads invalidates the cached decisions, so e.g. changing the log level doesn't redo them
+    std::shared_ptr<const ConfigSnapshot> current = getConfigSnapshot();
+    snapshot->generation = current->generation + (current->hasSameDecisionInputs(*snapshot) ? 0 : 1);
+    // The timers and the log check separate flags, since loading the snapshot is too slow for them
+    setProfilingEnabled(snapshot->profiling);
+    setLogLevel(snapshot->logLevel);
+    traceConfig(*snapshot);
+    std::atomic_store(&currentSnapshot, std::shared_ptr<const ConfigSnapshot>(std::move(snapshot)));
+}
+
+// Must be called with configMutex held
+static void writeConfigLocked() {
+    std::shared_ptr<const ConfigSnapshot> snapshot = getConfigSnapshot();
+    writeSnapshot(*snapshot, getConfig().config);
+    getConfig().Write();
+
+    // The level overrides are only replaced when they are edited, so they only need writing if the pointer has changed
+    if(snapshot->levelOverrides != writtenLevelOverrides)   {
+        if(!snapshot->levelOverrides->write(getLevelOverridesPath()))   {
+            getLogger().error("Failed to write level overrides");
+        }
+        writtenLevelOverrides = snapshot->levelOverrides;
+    }
+
+    configDirty = false;
+    lastWriteVersion = getConfigFileVersion();
+}
+
+// Reloads the config if it was modified outside of the game. Must be called with configMutex held
+static void reloadIfModifiedLocked()    {
+    if(getConfigFileVersion() == lastWriteVersion)  {return;}
+
+    getLogger().info("Config file changed on disk, reloading . . .");
+    getConfig().Reload();
+    createDefaultConfig();
+    std::shared_ptr<ConfigSnapshot> snapshot = readSnapshot(getConfig().config);
+    // The level overrides aren't in the config file, so keep the ones already loaded
+    snapshot->levelOverrides = getConfigSnapshot()->levelOverrides;
+    publishSnapshot(std::move(snapshot));
+    lastWriteVersion = getConfigFileVersion();
+}
+
+void loadConfig()   {
+    std::lock_guard<std::mutex> lock(configMutex);
+
+    getConfig().Load(); // Load the config file
+    createDefaultConfig(); // Create the default config file if it doesn't already exist
+    std::shared_ptr<ConfigSnapshot> snapshot = readSnapshot(getConfig().config);
+    snapshot->levelOverrides = std::make_shared<const LevelOverrideList>(LevelOverrideList::read(getLevelOverridesPath()));
+    writtenLevelOverrides = snapshot->levelOverrides;
+    getLogger().info("Loaded %lu level overrides", (unsigned long) snapshot->levelOverrides->size());
+    publishSnapshot(std::move(snapshot));
+    lastWriteVersion = getConfigFileVersion();
+}
+
+void editConfig(const std::function<void(ConfigSnapshot&)>& edit)   {
+    std::lock_guard<std::mutex> lock(configMutex);
+
+    // Snapshots are immutable once published, so edit a copy and swap it in
+    std::shared_ptr<ConfigSnapshot> newSnapshot = std::make_shared<ConfigSnapshot>(*getConfigSnapshot());
+    edit(*newSnapshot);
+    publishSnapshot(std::move(newSnapshot));
+
+    configDirty = true;
+    lastEditTime = std::chrono::steady_clock::now();
+    configChanged.notify_one();
+}
+
+void editPlaylists(const std::function<void(PlaylistIndex&)>& edit)  {
+    editConfig([&edit](ConfigSnapshot& config) {
+        std::shared_ptr<PlaylistIndex> playlists = std::make_shared<PlaylistIndex>(*config.playlists);
+        edit(*playlists);
+        config.playlists = std::move(playlists);
+    });
+}
+
+void setLevelOverride(std::string_view levelId, LevelOverride state)  {
+    editConfig([levelId, state](ConfigSnapshot& config) {
+        std::shared_ptr<LevelOverrideList> levelOverrides = std::make_shared<LevelOverrideList>(*config.levelOverrides);
+        levelOverrides->set(levelId, state);
+        config.levelOverrides = std::move(levelOverrides);
+    });
+}
+
+void flushConfig()  {
+    std::lock_guard<std::mutex> lock(configMutex);
+    if(configDirty) {
+        writeConfigLocked();
+    }
+}
+
+static void configWriterThread()    {
+    std::unique_lock<std::mutex> lock(configMutex);
+    while(true) {
+        if(configDirty) {
+            // Wait until the edits stop coming in, so that a burst of changes only results in one write
+            std::chrono::steady_clock::time_point flushTime = lastEditTime + WRITE_DEBOUNCE;
+            if(std::chrono::steady_clock::now() < flushTime)    {
+                configChanged.wait_until(lock, flushTime);
+                continue;
+            }
+
+            writeConfigLocked();
+        }   else    {
+            configChanged.wait_for(lock, WATCH_INTERVAL);
+            // Any edits made in game take priority over changes on disk
+            if(!configDirty)    {
+                reloadIfModifiedLocked();
+            }
+        }
+    }
+}
+
+void startConfigWriter()    {
+    std::thread(configWriterThread).detach();
+}
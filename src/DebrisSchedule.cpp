@@ -0,0 +1,73 @@
+#include "DebrisSchedule.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// The window is moved along in steps of this fraction of its length
+static constexpr int STEPS_PER_WINDOW = 8;
+
+DebrisSchedule DebrisSchedule::build(const std::vector<float>& noteTimes, const DebrisScheduleSettings& settings)  {
+    DebrisSchedule schedule;
+    if(noteTimes.empty() || settings.windowSeconds <= 0)   {return schedule;}
+
+    float stepSeconds = settings.windowSeconds / STEPS_PER_WINDOW;
+    // Written so that a NaN note time gives a length of 0
+    float length = noteTimes.back() > 0.0f ? std::min(noteTimes.back(), MAX_LENGTH_SECONDS) : 0.0f;
+    size_t stepCount = (size_t) std::ceil(length / stepSeconds) + 1;
+
+    // Walk the window along the song, with one pointer to the first note in the window and one past the last
+    size_t windowStart = 0;
+    size_t windowEnd = 0;
+    bool reduced = false;
+    for(size_t step = 0; step < stepCount; step++)  {
+        float time = step * stepSeconds;
+        while(windowStart < noteTimes.size() && noteTimes[windowStart] < time) {windowStart++;}
+        while(windowEnd < noteTimes.size() && noteTimes[windowEnd] < time + settings.windowSeconds) {windowEnd++;}
+        float notesPerSecond = (windowEnd - windowStart) / settings.windowSeconds;
+
+        if(!reduced && notesPerSecond > settings.reduceNotesPerSecond)   {
+            reduced = true;
+            schedule.intervals.push_back(DebrisInterval {std::max(0.0f, time - settings.leadTime), 0.0f});
+        }   else if(reduced && notesPerSecond < settings.restoreNotesPerSecond)  {
+            // The previous window was still dense, and it ended one step before the end of this one
+            reduced = false;
+            schedule.intervals.back().end = time + settings.windowSeconds - stepSeconds;
+        }
+    }
+    if(reduced) {
+        schedule.intervals.back().end = length + settings.windowSeconds;
+    }
+
+    // Join intervals that are close together. Lead time can also make an interval start before the previous one ends
+    std::vector<DebrisInterval>& intervals = schedule.intervals;
+    size_t joined = 0;
+    for(size_t i = 1; i < intervals.size(); i++)    {
+        if(intervals[i].start - intervals[joined].end < settings.minimumGap)    {
+            intervals[joined].end = std::max(intervals[joined].end, intervals[i].end);
+        }   else    {
+            intervals[++joined] = intervals[i];
+        }
+    }
+    if(!intervals.empty())  {
+        intervals.resize(joined + 1);
+    }
+
+    return schedule;
+}
+
+DebrisScheduleCursor::DebrisScheduleCursor(const DebrisSchedule& schedule) :
+    begin(schedule.getIntervals().data()),
+    current(begin),
+    end(begin + schedule.getIntervals().size()) {}
+
+bool DebrisScheduleCursor::isReduced(float songTime)  {
+    if(songTime < lastSongTime) {
+        current = begin;
+    }
+    lastSongTime = songTime;
+
+    while(current != end && current->end <= songTime)   {
+        current++;
+    }
+    return current != end && current->start <= songTime;
+}
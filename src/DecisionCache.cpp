@@ -0,0 +1,38 @@
+#include "DecisionCache.hpp"
+
+#include <functional>
+
+size_t DecisionKeyHash::operator()(const DecisionKey& key) const  {
+    size_t hash = std::hash<std::string>()(key.levelId);
+    hash ^= std::hash<std::string>()(key.characteristic) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int>()(key.difficulty) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+DecisionCache::DecisionCache(size_t capacity) : capacity(capacity) {
+    lookup.reserve(capacity);
+}
+
+CachedDecision& DecisionCache::getOrInsert(const DecisionKey& key) {
+    auto existing = lookup.find(key);
+    if(existing != lookup.end())    {
+        // Move the entry to the front, since it is now the most recently used
+        entries.splice(entries.begin(), entries, existing->second);
+        return existing->second->second;
+    }
+
+    // Evict the least recently used entry if necessary
+    if(entries.size() >= capacity)  {
+        lookup.erase(entries.back().first);
+        entries.pop_back();
+    }
+
+    entries.emplace_front(key, CachedDecision());
+    lookup.emplace(key, entries.begin());
+    return entries.front().second;
+}
+
+void DecisionCache::clear() {
+    entries.clear();
+    lookup.clear();
+}
@@ -0,0 +1,193 @@
+#include "DecisionEngine.hpp"
+#include "Hash.hpp"
+
+const char* reasonToString(OverrideReason reason)   {
+    switch(reason)  {
+        case OverrideReason::NPS_THRESHOLD:
+            return "NPS threshold";
+        case OverrideReason::PEAK_DENSITY:
+            return "peak density threshold";
+        case OverrideReason::PLAYLIST:
+            return "playlist";
+        case OverrideReason::RULE:
+            return "rule";
+        case OverrideReason::FRAME_TIME:
+            return "measured frame time";
+        case OverrideReason::LEVEL:
+            return "level override";
+        default:
+            return "none";
+    }
+}
+
+DecisionEngine::DecisionEngine(size_t cacheCapacity) : cache(cacheCapacity) {}
+
+std::optional<Decision> DecisionEngine::decide(const ConfigSnapshot& config, const DecisionKey& key, DecisionInputSource& inputs) {
+    // The cached peak NPS depends on the density settings, unlike the other inputs
+    if(config.densityWindow != cachedDensityWindow || config.densityPercentile != cachedDensityPercentile)    {
+        cache.clear();
+        cachedDensityWindow = config.densityWindow;
+        cachedDensityPercentile = config.densityPercentile;
+    }
+
+    CachedDecision& cached = cache.getOrInsert(key);
+
+    // Only redo the decision if the config has changed since it was made
+    if(cached.configGeneration != config.generation)    {
+        std::optional<Decision> decision = decideUncached(config, key, cached, inputs);
+        if(!decision)   {return std::nullopt;}
+
+        cached.willOverride = decision->willOverride;
+        cached.reason = decision->reason;
+        cached.rule = decision->rule;
+        cached.configGeneration = config.generation;
+    }
+
+    return Decision {cached.willOverride, cached.reason, cached.rule};
+}
+
+void DecisionEngine::clear()    {
+    cache.clear();
+}
+
+// Finds the packs of the level if they aren't cached, returning false if the input source couldn't find them
+bool DecisionEngine::findPacks(CachedDecision& cached, DecisionInputSource& inputs)   {
+    if(cached.packsKnown)   {return true;}
+
+    cached.packs.clear();
+    if(!inputs.findLevelPacks(cached.packs))    {return false;}
+
+    cached.packHashes.clear();
+    for(const LevelPack& pack : cached.packs)   {
+        if(!pack.id.empty()) {cached.packHashes.push_back(hashString(pack.id));}
+        if(!pack.name.empty()) {cached.packHashes.push_back(hashString(pack.name));}
+    }
+    cached.packsKnown = true;
+    return true;
+}
+
+// Fills in the inputs that the rules depend on, calculating them if they aren't cached
+std::optional<RuleInputs> DecisionEngine::findRuleInputs(const RuleSet& rules, const DecisionKey& key, CachedDecision& cached, DecisionInputSource& inputs)  {
+    RuleInputs ruleInputs {0.0f, -1.0f, 0.0f, key.difficulty, hashString(key.characteristic), nullptr, 0};
+
+    if(rules.usesField(RuleField::NPS)) {
+        if(!cached.notesPerSecond && !(cached.notesPerSecond = inputs.calculateNotesPerSecond()))  {
+            return std::nullopt;
+        }
+        ruleInputs.notesPerSecond = *cached.notesPerSecond;
+    }
+    if(rules.usesField(RuleField::PEAK_NPS))    {
+        if(!cached.peakNotesPerSecond)  {
+            cached.peakNotesPerSecond = inputs.calculatePeakNotesPerSecond();
+        }
+        ruleInputs.peakNotesPerSecond = *cached.peakNotesPerSecond;
+    }
+    if(rules.usesField(RuleField::DURATION))    {
+        if(!cached.duration && !(cached.duration = inputs.calculateDuration()))    {
+            return std::nullopt;
+        }
+        ruleInputs.duration = *cached.duration;
+    }
+    if(rules.usesField(RuleField::PACK))    {
+        if(!findPacks(cached, inputs))  {
+            return std::nullopt;
+        }
+        ruleInputs.packHashes = cached.packHashes.data();
+        ruleInputs.packHashCount = cached.packHashes.size();
+    }
+
+    return ruleInputs;
+}
+
+// A pack without an ID or name shouldn't match a pattern like "*"
+static bool matchesPlaylistPattern(const ConfigSnapshot& config, const std::string& packIdOrName)   {
+    return !packIdOrName.empty() && config.playlistPatterns->matches(packIdOrName);
+}
+
+// Checks every pack that the level is in against the overridden playlists
+static bool isAnyPackOverridden(const ConfigSnapshot& config, const std::vector<LevelPack>& packs)   {
+    for(const LevelPack& pack : packs)  {
+        if(config.playlists->contains(pack.id, pack.name) || matchesPlaylistPattern(config, pack.id) || matchesPlaylistPattern(config, pack.name))    {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<Decision> DecisionEngine::decideUncached(const ConfigSnapshot& config, const DecisionKey& key, CachedDecision& cached, DecisionInputSource& inputs) {
+    Mode overrideMode = config.mode;
+
+    // Levels that are forced on or off come before everything else
+    LevelOverride levelOverride = config.levelOverrides->find(key.levelId);
+    if(levelOverride != LevelOverride::NONE)    {
+        return Decision {levelOverride == LevelOverride::ALWAYS, OverrideReason::LEVEL};
+    }
+
+    // The first rule that fires decides, ignoring the threshold and playlists
+    const RuleSet& rules = *config.rules;
+    if(!rules.empty())  {
+        std::optional<RuleInputs> ruleInputs = findRuleInputs(rules, key, cached, inputs);
+        if(!ruleInputs) {return std::nullopt;}
+
+        int rule = rules.evaluate(*ruleInputs);
+        if(rule >= 0)   {
+            return Decision {rules.getOverride(rule), OverrideReason::RULE, rule};
+        }
+    }
+
+    // In adaptive mode, the frame times measured in earlier plays replace the NPS threshold
+    MeasuredPerformance measured = MeasuredPerformance::UNKNOWN;
+    if(config.adaptiveMode) {
+        if(!cached.measuredPerformance) {
+            cached.measuredPerformance = inputs.findMeasuredPerformance();
+        }
+        measured = *cached.measuredPerformance;
+
+        bool overBudget = measured == MeasuredPerformance::OVER_BUDGET;
+        if(measured != MeasuredPerformance::UNKNOWN && ((overrideMode == Mode::ENABLE && overBudget) || (overrideMode == Mode::DISABLE && !overBudget)))  {
+            return Decision {true, OverrideReason::FRAME_TIME};
+        }
+    }
+
+    // If the NPS threshold is enabled, and the difficulty hasn't been measured
+    float npsThreshold = config.notesPerSecondThreshold;
+    if(npsThreshold > 0 && measured == MeasuredPerformance::UNKNOWN)    {
+        OverrideReason reason = OverrideReason::NPS_THRESHOLD;
+        float nps = -1.0f;
+
+        // Use the peak density if it is enabled, falling back to the average if the difficulty hasn't been analyzed
+        if(config.densityMode == DensityMode::PEAK) {
+            if(!cached.peakNotesPerSecond)  {
+                cached.peakNotesPerSecond = inputs.calculatePeakNotesPerSecond();
+            }
+            if(*cached.peakNotesPerSecond >= 0) {
+                nps = *cached.peakNotesPerSecond;
+                reason = OverrideReason::PEAK_DENSITY;
+            }
+        }
+        if(reason == OverrideReason::NPS_THRESHOLD) {
+            if(!cached.notesPerSecond && !(cached.notesPerSecond = inputs.calculateNotesPerSecond()))  {
+                return std::nullopt;
+            }
+            nps = *cached.notesPerSecond;
+        }
+
+        // We either check if the NPS is greater or lesser depending on the mode
+        if((overrideMode == Mode::ENABLE && nps > npsThreshold) || (overrideMode == Mode::DISABLE && nps < npsThreshold))   {
+            return Decision {true, reason};
+        }
+    }
+
+    // Check the song's playlist to see if we need to override. The pack lookup can be skipped if no playlists are overridden
+    if(config.playlists->empty() && config.playlistPatterns->empty())    {
+        return Decision {false, OverrideReason::NONE};
+    }
+    if(!findPacks(cached, inputs))  {
+        return std::nullopt;
+    }
+    if(isAnyPackOverridden(config, cached.packs)) {
+        return Decision {true, OverrideReason::PLAYLIST};
+    }
+
+    return Decision {false, OverrideReason::NONE};
+}
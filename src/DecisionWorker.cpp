@@ -0,0 +1,154 @@
+#include "DecisionWorker.hpp"
+#include "LevelPacks.hpp"
+#include "NpsIndexer.hpp"
+#include "PerformanceMonitor.hpp"
+#include "TraceRecorder.hpp"
+#include "main.hpp"
+#include "AsyncLog.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Decides whether to override, caching recent decisions so that switching back and forth between difficulties doesn't redo the work
+static DecisionEngine decisionEngine(256);
+// The engine is used from both the main thread and the background thread
+static std::mutex engineMutex;
+
+struct DecisionRequest {
+    uint64_t sequence;
+    DecisionKey key;
+};
+
+// Guards the request and result below
+static std::mutex requestMutex;
+static std::condition_variable requestChanged;
+static std::condition_variable resultChanged;
+static bool workerStarted = false;
+
+static uint64_t latestSequence = 0; // Sequence number of the most recent request. Incrementing this cancels the others
+static std::optional<DecisionRequest> pendingRequest;
+static DecisionKey resultKey;
+static uint64_t resultSequence = 0;
+static uint64_t resultGeneration = 0; // Generation of the config snapshot the result was decided with
+static std::optional<Decision> result;
+
+// Finds the inputs to the decision engine without touching the game, so that it can be used on the background thread
+class IndexedInputSource : public DecisionInputSource {
+public:
+    explicit IndexedInputSource(const DecisionKey& key) : key(key) {}
+
+    std::optional<float> calculateNotesPerSecond() override    {
+        std::optional<NpsIndexEntry> indexed = findIndexedDifficulty(key.levelId, key.characteristic, key.difficulty);
+        if(!indexed)    {return std::nullopt;}
+        return indexed->getNotesPerSecond();
+    }
+
+    float calculatePeakNotesPerSecond() override    {
+        std::optional<NpsIndexEntry> indexed = findIndexedDifficulty(key.levelId, key.characteristic, key.difficulty);
+        if(indexed && indexed->percentileNotesPerSecond > 0)    {
+            return indexed->percentileNotesPerSecond;
+        }
+        return -1.0f;
+    }
+
+    std::optional<float> calculateDuration() override  {
+        std::optional<NpsIndexEntry> indexed = findIndexedDifficulty(key.levelId, key.characteristic, key.difficulty);
+        if(!indexed)    {return std::nullopt;}
+        return indexed->duration;
+    }
+
+    bool findLevelPacks(std::vector<LevelPack>& packs) override {
+        return ::findLevelPacks(key.levelId, packs);
+    }
+
+    MeasuredPerformance findMeasuredPerformance() override  {
+        return ::findMeasuredPerformance(key.levelId, key.characteristic, key.difficulty);
+    }
+
+private:
+    const DecisionKey& key;
+};
+
+// Must be called with engineMutex held. If a trace is being recorded, this also records the inputs and timing of the decision
+static std::optional<Decision> runDecisionEngine(const ConfigSnapshot& config, const DecisionKey& key, DecisionInputSource& inputs)    {
+    if(!isTraceRecording()) {
+        return decisionEngine.decide(config, key, inputs);
+    }
+
+    Trace::RecordingInputSource recordingInputs(inputs);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::optional<Decision> decision = decisionEngine.decide(config, key, recordingInputs);
+    uint64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    traceDecide(key, config.generation, latency, recordingInputs.getInputs(), decision);
+    return decision;
+}
+
+static void decisionWorkerThread()  {
+    std::unique_lock<std::mutex> lock(requestMutex);
+    while(true) {
+        requestChanged.wait(lock, [] {return pendingRequest.has_value();});
+        DecisionRequest request = std::move(*pendingRequest);
+        pendingRequest.reset();
+        lock.unlock();
+
+        std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+        std::optional<Decision> decision;
+        {
+            std::lock_guard<std::mutex> engineLock(engineMutex);
+            IndexedInputSource inputs(request.key);
+            decision = runDecisionEngine(*config, request.key, inputs);
+        }
+
+        lock.lock();
+        // Throw the result away if another difficulty was selected in the meantime
+        if(request.sequence != latestSequence)  {continue;}
+
+        resultKey = std::move(request.key);
+        resultSequence = request.sequence;
+        resultGeneration = config->generation;
+        result = decision;
+        resultChanged.notify_all();
+    }
+}
+
+void requestDecision(DecisionKey key)   {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    if(!workerStarted)  {
+        std::thread(decisionWorkerThread).detach();
+        workerStarted = true;
+    }
+
+    // Replacing the pending request cancels it, and bumping the sequence cancels the one in progress
+    pendingRequest = DecisionRequest {++latestSequence, std::move(key)};
+    requestChanged.notify_one();
+}
+
+std::optional<Decision> waitForDecision(const DecisionKey& key, std::chrono::milliseconds timeout)  {
+    std::unique_lock<std::mutex> lock(requestMutex);
+    if(!resultChanged.wait_for(lock, timeout, [] {return resultSequence == latestSequence;}))  {
+        return std::nullopt;
+    }
+    // A result decided with an older config can't be used either, but its inputs are cached so deciding again is cheap
+    if(latestSequence == 0 || !(resultKey == key) || resultGeneration != getConfigSnapshot()->generation)  {
+        return std::nullopt;
+    }
+    return result;
+}
+
+Decision decideNow(const ConfigSnapshot& config, const DecisionKey& key, DecisionInputSource& inputs)   {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    std::optional<Decision> decision = runDecisionEngine(config, key, inputs);
+    if(!decision)   {
+        ASYNC_LOG_ERROR("Input source couldn't find every input, not overriding");
+        return Decision {false, OverrideReason::NONE};
+    }
+    return *decision;
+}
+
+void clearDecisions()   {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    decisionEngine.clear();
+    traceClearDecisions();
+}
@@ -0,0 +1,51 @@
+#include "DensityAnalyzer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+DensityAnalyzer::DensityAnalyzer(float windowSeconds, float percentile) :
+    windowSeconds(windowSeconds),
+    binSeconds(windowSeconds / BINS_PER_WINDOW),
+    percentile(std::clamp(percentile, 0.0f, 1.0f)) {}
+
+DensityResult DensityAnalyzer::analyze(const std::vector<float>& noteTimes, float songDuration)  {
+    if(noteTimes.empty() || windowSeconds <= 0) {
+        return DensityResult {0.0f, 0.0f};
+    }
+
+    // Some maps have notes after the end of the audio, so make sure that those land in a bin too.
+    // A note time far past the end would make the bins unbounded though, so notes past the late limit are left out of every bin
+    float length = std::max(songDuration, std::min(noteTimes.back(), songDuration + LATE_NOTE_SECONDS));
+    // Written so that a NaN length becomes 0
+    length = length > 0.0f ? std::min(length, MAX_LENGTH_SECONDS) : 0.0f;
+    size_t binCount = (size_t) std::ceil(length / binSeconds) + 1;
+    // Songs shorter than the window are treated as one window
+    size_t windowCount = binCount > BINS_PER_WINDOW ? binCount - BINS_PER_WINDOW + 1 : 1;
+
+    // Since the note times are sorted, the prefix counts can be filled in one sweep without counting each bin separately
+    prefixCounts.resize(binCount + 1);
+    size_t note = 0;
+    for(size_t bin = 0; bin <= binCount; bin++) {
+        float binStart = bin * binSeconds;
+        while(note < noteTimes.size() && noteTimes[note] < binStart)    {
+            note++;
+        }
+        prefixCounts[bin] = (uint32_t) note;
+    }
+
+    // Each window is the difference of two prefix counts. This loop has no dependencies between iterations, so it vectorizes
+    windowCounts.resize(windowCount);
+    const uint32_t* windowStarts = prefixCounts.data();
+    const uint32_t* windowEnds = prefixCounts.data() + std::min<size_t>(BINS_PER_WINDOW, binCount);
+    for(size_t i = 0; i < windowCount; i++) {
+        windowCounts[i] = windowEnds[i] - windowStarts[i];
+    }
+
+    uint32_t peakCount = *std::max_element(windowCounts.begin(), windowCounts.end());
+
+    size_t percentileIndex = std::min(windowCount - 1, (size_t) (percentile * (windowCount - 1) + 0.5f));
+    std::nth_element(windowCounts.begin(), windowCounts.begin() + percentileIndex, windowCounts.end());
+    uint32_t percentileCount = windowCounts[percentileIndex];
+
+    return DensityResult {peakCount / windowSeconds, percentileCount / windowSeconds};
+}
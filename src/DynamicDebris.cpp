@@ -0,0 +1,137 @@
+#include "DynamicDebris.hpp"
+#include "DebrisSchedule.hpp"
+#include "LevelFileReader.hpp"
+#include "main.hpp"
+
+#include "GlobalNamespace/CustomPreviewBeatmapLevel.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace GlobalNamespace;
+
+// A schedule built in the background, along with which level start it was built for
+struct BuiltSchedule {
+    uint64_t generation;
+    DebrisSchedule schedule;
+};
+
+// A level start waiting for its schedule to be built
+struct ScheduleJob {
+    uint64_t generation;
+    std::string levelPath;
+    DecisionKey key;
+    DebrisScheduleSettings settings;
+};
+
+// Incremented whenever a level starts, so that a schedule finished after the next level has started is ignored
+static std::atomic<uint64_t> scheduleGeneration = 0;
+// Only accessed with std::atomic_load and std::atomic_store
+static std::shared_ptr<const BuiltSchedule> builtSchedule;
+
+// Guards the pending job. One long-lived thread builds every schedule, rather than starting a thread per level
+static std::mutex jobMutex;
+static std::condition_variable jobAvailable;
+static bool workerStarted = false;
+static std::optional<ScheduleJob> pendingJob;
+
+// Only used on the main thread
+static bool active = false;
+static std::shared_ptr<const BuiltSchedule> activeSchedule;
+static DebrisScheduleCursor cursor;
+
+static void buildSchedule(const ScheduleJob& job)  {
+    // The level was already left before the worker got to it
+    if(scheduleGeneration.load() != job.generation) {return;}
+
+    std::shared_ptr<BuiltSchedule> built = std::make_shared<BuiltSchedule>();
+    built->generation = job.generation;
+
+    // Only the beatmap of the difficulty being played is read. The NPS index doesn't keep note times, since they would make it many times larger
+    std::optional<std::vector<float>> noteTimes = readLevelDifficulty(job.levelPath, job.key.characteristic, job.key.difficulty);
+    if(noteTimes)   {
+        built->schedule = DebrisSchedule::build(*noteTimes, job.settings);
+        ASYNC_LOG_INFO("Built debris schedule with %zu intervals", built->schedule.getIntervals().size());
+    }   else    {
+        // An empty schedule leaves debris on for the whole song, which is what the level would have had without dynamic debris
+        ASYNC_LOG_WARNING("Couldn't read the notes of %s, not reducing debris", job.key.levelId.c_str());
+    }
+
+    if(scheduleGeneration.load() == job.generation) {
+        std::atomic_store(&builtSchedule, std::shared_ptr<const BuiltSchedule>(std::move(built)));
+    }
+}
+
+static void scheduleWorkerThread()  {
+    std::unique_lock<std::mutex> lock(jobMutex);
+    while(true) {
+        jobAvailable.wait(lock, [] {return pendingJob.has_value();});
+        ScheduleJob job = std::move(*pendingJob);
+        pendingJob.reset();
+        lock.unlock();
+
+        buildSchedule(job);
+        lock.lock();
+    }
+}
+
+bool startDynamicDebris(IPreviewBeatmapLevel* level, const DecisionKey& key, const ConfigSnapshot& config)  {
+    stopDynamicDebris();
+    // The schedule is made from the NPS threshold, so there is nothing to build it from when reduce debris is being disabled or the threshold is off
+    if(!config.dynamicDebris || config.mode != Mode::ENABLE || config.notesPerSecondThreshold <= 0)  {return false;}
+
+    // Only custom levels can be read from disk
+    Il2CppClass* levelClass = il2cpp_functions::object_get_class(reinterpret_cast<Il2CppObject*>(level));
+    if(!il2cpp_functions::class_is_assignable_from(classof(CustomPreviewBeatmapLevel*), levelClass))  {return false;}
+    std::string levelPath = to_utf8(csstrtostr(reinterpret_cast<CustomPreviewBeatmapLevel*>(level)->get_customLevelPath()));
+
+    DebrisScheduleSettings settings {
+        config.densityWindow,
+        config.notesPerSecondThreshold,
+        config.notesPerSecondThreshold * config.dynamicDebrisHysteresis,
+        config.dynamicDebrisLeadTime,
+        config.densityWindow // Turning debris back on for less than a window isn't worth the flicker
+    };
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if(!workerStarted)  {
+            std::thread(scheduleWorkerThread).detach();
+            workerStarted = true;
+        }
+        // Replacing the pending job cancels it, since its level has already been left
+        pendingJob = ScheduleJob {scheduleGeneration.load(), std::move(levelPath), key, settings};
+        jobAvailable.notify_one();
+    }
+
+    active = true;
+    return true;
+}
+
+void stopDynamicDebris()  {
+    scheduleGeneration++;
+    std::atomic_store(&builtSchedule, std::shared_ptr<const BuiltSchedule>());
+    active = false;
+    activeSchedule = nullptr;
+    cursor = DebrisScheduleCursor();
+}
+
+bool isDynamicDebrisActive()  {
+    return active;
+}
+
+bool isDebrisReduced(float songTime)  {
+    if(!active) {return false;}
+
+    if(!activeSchedule) {
+        std::shared_ptr<const BuiltSchedule> built = std::atomic_load(&builtSchedule);
+        // Keep debris reduced until the schedule is ready. It normally finishes long before the first note is cut
+        if(!built || built->generation != scheduleGeneration.load())  {return true;}
+
+        activeSchedule = std::move(built);
+        cursor = DebrisScheduleCursor(activeSchedule->schedule);
+    }
+    return cursor.isReduced(songTime);
+}
@@ -0,0 +1,42 @@
+#include "FrameTimeSampler.hpp"
+
+#include <algorithm>
+
+void FrameTimeSampler::reset(float percentile)  {
+    this->percentile = std::clamp(percentile, 0.0f, 1.0f);
+    next = 0;
+    totalSamples = 0;
+    sinceMeasured = 0;
+    worst = 0.0f;
+}
+
+void FrameTimeSampler::addSample(float frameTime)   {
+    samples[next] = frameTime;
+    next = (next + 1) % CAPACITY;
+    totalSamples++;
+
+    if(++sinceMeasured >= CAPACITY / 2 && totalSamples >= CAPACITY)   {
+        measure();
+    }
+}
+
+std::optional<float> FrameTimeSampler::finish()   {
+    if(totalSamples < MINIMUM_SAMPLES)  {return std::nullopt;}
+
+    // Include the frames since the last measurement, unless the level ended right after one
+    if(sinceMeasured > 0)   {
+        measure();
+    }
+    return worst;
+}
+
+// Finds the percentile of the frames in the ring
+void FrameTimeSampler::measure()    {
+    size_t count = std::min(totalSamples, CAPACITY);
+    std::copy(samples.begin(), samples.begin() + count, scratch.begin());
+
+    size_t index = std::min(count - 1, (size_t) (percentile * count));
+    std::nth_element(scratch.begin(), scratch.begin() + index, scratch.begin() + count);
+    worst = std::max(worst, scratch[index]);
+    sinceMeasured = 0;
+}
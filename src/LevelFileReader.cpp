@@ -0,0 +1,167 @@
+#include "LevelFileReader.hpp"
+#include "Difficulty.hpp"
+
+#include "beatsaber-hook/shared/config/config-utils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+
+// Reads a whole file into a string, returning false if it couldn't be opened
+static bool readFile(const std::string& path, std::string& contents) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file)   {return false;}
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    contents.resize(length > 0 ? length : 0);
+    bool success = fread(contents.data(), 1, contents.size(), file) == contents.size();
+    fclose(file);
+    return success;
+}
+
+static bool readJsonFile(const std::string& path, rapidjson::Document& document)  {
+    std::string contents;
+    if(!readFile(path, contents))   {return false;}
+
+    document.Parse(contents.c_str(), contents.length());
+    return !document.HasParseError() && document.IsObject();
+}
+
+static bool readDifficultyNotes(const std::string& path, float secondsPerBeat, std::vector<float>& noteTimes)    {
+    rapidjson::Document beatmap;
+    if(!readJsonFile(path, beatmap) || !beatmap.HasMember("_notes") || !beatmap["_notes"].IsArray())  {
+        return false;
+    }
+
+    rapidjson::Value::ConstArray notes = beatmap["_notes"].GetArray();
+    noteTimes.reserve(notes.Size());
+    for(const rapidjson::Value& note : notes)   {
+        // Custom maps are made by hand, so check every value's type rather than trusting it
+        if(!note.IsObject() || !note.HasMember("_type") || !note.HasMember("_time") || !note["_type"].IsInt() || !note["_time"].IsNumber())  {continue;}
+
+        // Types 0 and 1 are the two note colours, everything else (bombs) isn't cuttable
+        int type = note["_type"].GetInt();
+        if(type == 0 || type == 1)  {
+            noteTimes.push_back(note["_time"].GetFloat() * secondsPerBeat);
+        }
+    }
+
+    // Beatmaps are almost always saved in order, but this isn't guaranteed
+    if(!std::is_sorted(noteTimes.begin(), noteTimes.end())) {
+        std::sort(noteTimes.begin(), noteTimes.end());
+    }
+    return true;
+}
+
+// Reads the info.dat of a level, returning false if it is missing or doesn't have the fields needed to read the beatmaps
+static bool readInfo(const std::string& levelPath, rapidjson::Document& info, float& secondsPerBeat)   {
+    // Different versions of the editors use different capitalisation
+    if(!readJsonFile(levelPath + "/Info.dat", info) && !readJsonFile(levelPath + "/info.dat", info))  {
+        return false;
+    }
+    if(!info.HasMember("_beatsPerMinute") || !info["_beatsPerMinute"].IsNumber() || !info.HasMember("_difficultyBeatmapSets") || !info["_difficultyBeatmapSets"].IsArray())    {
+        return false;
+    }
+
+    float beatsPerMinute = info["_beatsPerMinute"].GetFloat();
+    if(beatsPerMinute <= 0) {return false;}
+    secondsPerBeat = 60.0f / beatsPerMinute;
+    return true;
+}
+
+// Calls the function with the characteristic, difficulty and file name of every valid beatmap in the info.dat
+template<class F>
+static void forEachBeatmap(const rapidjson::Document& info, F&& function)   {
+    for(const rapidjson::Value& beatmapSet : info["_difficultyBeatmapSets"].GetArray())   {
+        if(!beatmapSet.IsObject() || !beatmapSet.HasMember("_beatmapCharacteristicName") || !beatmapSet["_beatmapCharacteristicName"].IsString()
+            || !beatmapSet.HasMember("_difficultyBeatmaps") || !beatmapSet["_difficultyBeatmaps"].IsArray())   {continue;}
+        std::string characteristic = beatmapSet["_beatmapCharacteristicName"].GetString();
+
+        for(const rapidjson::Value& beatmap : beatmapSet["_difficultyBeatmaps"].GetArray())   {
+            if(!beatmap.IsObject() || !beatmap.HasMember("_difficulty") || !beatmap["_difficulty"].IsString()
+                || !beatmap.HasMember("_beatmapFilename") || !beatmap["_beatmapFilename"].IsString())   {continue;}
+            std::optional<int> difficulty = parseDifficultyName(beatmap["_difficulty"].GetString());
+            if(!difficulty) {continue;}
+            function(characteristic, *difficulty, beatmap["_beatmapFilename"].GetString());
+        }
+    }
+}
+
+std::optional<LevelFileData> readLevelFiles(const std::string& levelPath)   {
+    rapidjson::Document info;
+    float secondsPerBeat;
+    if(!readInfo(levelPath, info, secondsPerBeat))  {return std::nullopt;}
+
+    LevelFileData levelData;
+    if(info.HasMember("_songFilename") && info["_songFilename"].IsString()) {
+        levelData.songDuration = readOggDuration(levelPath + "/" + info["_songFilename"].GetString());
+    }
+
+    forEachBeatmap(info, [&](const std::string& characteristic, int difficulty, const char* fileName) {
+        DifficultyNotes difficultyNotes {characteristic, difficulty, {}};
+        if(readDifficultyNotes(levelPath + "/" + fileName, secondsPerBeat, difficultyNotes.noteTimes))  {
+            levelData.difficulties.push_back(std::move(difficultyNotes));
+        }
+    });
+    return levelData;
+}
+
+std::optional<std::vector<float>> readLevelDifficulty(const std::string& levelPath, const std::string& characteristic, int difficulty)    {
+    rapidjson::Document info;
+    float secondsPerBeat;
+    if(!readInfo(levelPath, info, secondsPerBeat))  {return std::nullopt;}
+
+    std::optional<std::vector<float>> noteTimes;
+    forEachBeatmap(info, [&](const std::string& beatmapCharacteristic, int beatmapDifficulty, const char* fileName) {
+        if(noteTimes || beatmapDifficulty != difficulty || beatmapCharacteristic != characteristic)   {return;}
+        std::vector<float> times;
+        if(readDifficultyNotes(levelPath + "/" + fileName, secondsPerBeat, times))   {
+            noteTimes = std::move(times);
+        }
+    });
+    return noteTimes;
+}
+
+float readOggDuration(const std::string& path)  {
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file)   {return 0.0f;}
+
+    // The first page contains the vorbis identification header, which has the sample rate
+    uint8_t firstPage[128];
+    size_t firstPageLength = fread(firstPage, 1, sizeof(firstPage), file);
+    uint32_t sampleRate = 0;
+    if(firstPageLength > 27 && memcmp(firstPage, "OggS", 4) == 0)    {
+        size_t packetStart = 27 + firstPage[26]; // Skip the page header and segment table
+        if(packetStart + 16 <= firstPageLength && memcmp(firstPage + packetStart, "\x01vorbis", 7) == 0)  {
+            memcpy(&sampleRate, firstPage + packetStart + 12, sizeof(sampleRate));
+        }
+    }
+
+    // The granule position of the last page is the total number of samples
+    int64_t sampleCount = -1;
+    if(sampleRate > 0)  {
+        constexpr long TAIL_LENGTH = 65536;
+        fseek(file, 0, SEEK_END);
+        long fileLength = ftell(file);
+        long tailStart = std::max(0L, fileLength - TAIL_LENGTH);
+
+        std::vector<uint8_t> tail(fileLength - tailStart);
+        fseek(file, tailStart, SEEK_SET);
+        if(fread(tail.data(), 1, tail.size(), file) == tail.size() && tail.size() >= 14)   {
+            for(size_t i = tail.size() - 13; i-- > 0;)  {
+                if(memcmp(tail.data() + i, "OggS", 4) == 0)  {
+                    memcpy(&sampleCount, tail.data() + i + 6, sizeof(sampleCount));
+                    break;
+                }
+            }
+        }
+    }
+    fclose(file);
+
+    if(sampleRate == 0 || sampleCount <= 0) {return 0.0f;}
+    return (float) sampleCount / sampleRate;
+}
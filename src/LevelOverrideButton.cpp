@@ -0,0 +1,49 @@
+#include "LevelOverrideButton.hpp"
+#include "main.hpp"
+
+#include "questui/shared/BeatSaberUI.hpp"
+
+#include "UnityEngine/UI/Button.hpp"
+#include "UnityEngine/Transform.hpp"
+#include "UnityEngine/Vector2.hpp"
+
+#include "TMPro/TextMeshProUGUI.hpp"
+
+// The detail view is reused for every level, so one button is created and its level is changed on every selection
+static StandardLevelDetailView* buttonView = nullptr;
+static UnityEngine::UI::Button* overrideButton = nullptr;
+static std::string selectedLevelId;
+
+static std::string getButtonText(LevelOverride state)   {
+    switch(state)   {
+        case LevelOverride::ALWAYS:
+            return "Override: Always";
+        case LevelOverride::NEVER:
+            return "Override: Never";
+        default:
+            return "Override: Auto";
+    }
+}
+
+static void setButtonText(LevelOverride state)  {
+    overrideButton->GetComponentInChildren<TMPro::TextMeshProUGUI*>()->SetText(il2cpp_utils::createcsstr(getButtonText(state)));
+}
+
+static void onOverrideButtonClick() {
+    LevelOverride state = getConfigSnapshot()->levelOverrides->find(selectedLevelId);
+    LevelOverride newState = state == LevelOverride::NONE ? LevelOverride::ALWAYS : (state == LevelOverride::ALWAYS ? LevelOverride::NEVER : LevelOverride::NONE);
+
+    setLevelOverride(selectedLevelId, newState);
+    setButtonText(newState);
+}
+
+void updateLevelOverrideButton(StandardLevelDetailView* view, std::string levelId)  {
+    selectedLevelId = std::move(levelId);
+
+    if(view != buttonView)  {
+        // Put the button in the corner of the detail view, out of the way of the play buttons
+        overrideButton = QuestUI::BeatSaberUI::CreateUIButton(view->get_transform(), getButtonText(LevelOverride::NONE), UnityEngine::Vector2(28.0f, -6.0f), UnityEngine::Vector2(30.0f, 8.0f), onOverrideButtonClick);
+        buttonView = view;
+    }
+    setButtonText(getConfigSnapshot()->levelOverrides->find(selectedLevelId));
+}
@@ -0,0 +1,94 @@
+#include "LevelOverrideList.hpp"
+#include "Hash.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+// Finds the number of bytes between the current position and the end of the file
+static long getRemainingSize(FILE* file)    {
+    long position = ftell(file);
+    if(position < 0 || fseek(file, 0, SEEK_END) != 0)   {return -1;}
+    long end = ftell(file);
+    if(end < 0 || fseek(file, position, SEEK_SET) != 0)   {return -1;}
+    return end - position;
+}
+
+LevelOverrideList LevelOverrideList::read(const std::string& path)   {
+    LevelOverrideList list;
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file)   {return list;}
+
+    Header header;
+    if(fread(&header, sizeof(Header), 1, file) == 1 && header.magic == MAGIC && header.version == VERSION)  {
+        // The list falls back to empty if the file is too short for the count, rather than resizing to a corrupted count
+        long remainingSize = getRemainingSize(file);
+        if(remainingSize >= 0 && (uint64_t) header.count * (sizeof(uint64_t) + sizeof(LevelOverride)) <= (uint64_t) remainingSize)   {
+            list.hashes.resize(header.count);
+            list.states.resize(header.count);
+            if(fread(list.hashes.data(), sizeof(uint64_t), header.count, file) != header.count
+                || fread(list.states.data(), sizeof(LevelOverride), header.count, file) != header.count)    {
+                list.hashes.clear();
+                list.states.clear();
+            }
+        }
+    }
+    fclose(file);
+
+    // A list that isn't strictly sorted was corrupted, and would break the binary search
+    if(std::adjacent_find(list.hashes.begin(), list.hashes.end(), std::greater_equal<uint64_t>()) != list.hashes.end())   {
+        list.hashes.clear();
+        list.states.clear();
+    }
+    return list;
+}
+
+bool LevelOverrideList::write(const std::string& path) const   {
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if(!file)   {return false;}
+
+    Header header = {MAGIC, VERSION, (uint32_t) hashes.size(), 0};
+    bool success = fwrite(&header, sizeof(Header), 1, file) == 1;
+    success &= fwrite(hashes.data(), sizeof(uint64_t), hashes.size(), file) == hashes.size();
+    success &= fwrite(states.data(), sizeof(LevelOverride), states.size(), file) == states.size();
+    success &= fclose(file) == 0;
+
+    if(!success || rename(tempPath.c_str(), path.c_str()) != 0)  {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+LevelOverride LevelOverrideList::find(std::string_view levelId) const    {
+    return find(hashString(levelId));
+}
+
+LevelOverride LevelOverrideList::find(uint64_t levelHash) const  {
+    auto found = std::lower_bound(hashes.begin(), hashes.end(), levelHash);
+    if(found == hashes.end() || *found != levelHash)    {return LevelOverride::NONE;}
+    return states[found - hashes.begin()];
+}
+
+void LevelOverrideList::set(std::string_view levelId, LevelOverride state)  {
+    set(hashString(levelId), state);
+}
+
+void LevelOverrideList::set(uint64_t levelHash, LevelOverride state)    {
+    auto found = std::lower_bound(hashes.begin(), hashes.end(), levelHash);
+    size_t index = found - hashes.begin();
+    bool exists = found != hashes.end() && *found == levelHash;
+
+    if(state == LevelOverride::NONE)    {
+        if(exists)  {
+            hashes.erase(found);
+            states.erase(states.begin() + index);
+        }
+    }   else if(exists) {
+        states[index] = state;
+    }   else    {
+        hashes.insert(found, levelHash);
+        states.insert(states.begin() + index, state);
+    }
+}
@@ -0,0 +1,46 @@
+#include "LevelPackIndex.hpp"
+#include "Hash.hpp"
+
+uint64_t LevelPackIndex::hashLevel(std::string_view levelId) {
+    return hashString(levelId);
+}
+
+uint32_t LevelPackIndex::addPack(std::string_view packId, std::string_view packName)   {
+    packs.push_back(LevelPack {std::string(packId), std::string(packName)});
+    return packs.size() - 1;
+}
+
+void LevelPackIndex::addLevel(uint32_t pack, std::string_view levelId)  {
+    levels.push_back(LevelEntry {hashLevel(levelId), pack, (uint32_t) levelIds.size(), (uint32_t) levelId.size()});
+    levelIds.append(levelId);
+}
+
+void LevelPackIndex::finish()   {
+    // The IDs are only compared when the hashes are equal, so this is rarely more than comparing the hashes
+    std::sort(levels.begin(), levels.end(), [this](const LevelEntry& a, const LevelEntry& b) {
+        if(a.hash != b.hash)    {return a.hash < b.hash;}
+        int idOrder = getLevelId(a).compare(getLevelId(b));
+        return idOrder != 0 ? idOrder < 0 : a.pack < b.pack;
+    });
+
+    // Copy each ID once into a new string, now that the entries of each level are next to each other.
+    // A level can also be listed twice in the same pack, which shouldn't make the pack show up twice
+    std::string uniqueIds;
+    size_t kept = 0;
+    for(size_t i = 0; i < levels.size(); i++)   {
+        LevelEntry entry = levels[i];
+        bool sameLevel = kept > 0 && levels[kept - 1].hash == entry.hash
+            && std::string_view(uniqueIds).substr(levels[kept - 1].idOffset, levels[kept - 1].idLength) == getLevelId(entry);
+        if(sameLevel && levels[kept - 1].pack == entry.pack)  {continue;}
+
+        if(sameLevel)   {
+            entry.idOffset = levels[kept - 1].idOffset;
+        }   else    {
+            uniqueIds.append(getLevelId(entry));
+            entry.idOffset = (uint32_t) (uniqueIds.size() - entry.idLength);
+        }
+        levels[kept++] = entry;
+    }
+    levels.resize(kept);
+    levelIds = std::move(uniqueIds);
+}
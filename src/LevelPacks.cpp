@@ -0,0 +1,42 @@
+#include "LevelPacks.hpp"
+#include "Profiling.hpp"
+#include "main.hpp"
+
+#include "GlobalNamespace/IBeatmapLevelPack.hpp"
+#include "GlobalNamespace/IBeatmapLevelPackCollection.hpp"
+#include "GlobalNamespace/IAnnotatedBeatmapLevelCollection.hpp"
+#include "GlobalNamespace/IBeatmapLevelCollection.hpp"
+#include "GlobalNamespace/IPreviewBeatmapLevel.hpp"
+
+static std::shared_ptr<const LevelPackIndex> currentIndex;
+
+void updateLevelPacks(BeatmapLevelsModel* beatmapLevelsModel)  {
+    std::shared_ptr<LevelPackIndex> index = std::make_shared<LevelPackIndex>();
+
+    Array<IBeatmapLevelPack*>* levelPacks = beatmapLevelsModel->get_allLoadedBeatmapLevelPackCollection()->get_beatmapLevelPacks();
+    for(int i = 0; i < levelPacks->Length(); i++)   {
+        IBeatmapLevelPack* levelPack = levelPacks->values[i];
+        uint32_t pack = index->addPack(to_utf8(csstrtostr(levelPack->get_packID())), to_utf8(csstrtostr(levelPack->get_packName())));
+
+        IAnnotatedBeatmapLevelCollection* levelCollection = reinterpret_cast<IAnnotatedBeatmapLevelCollection*>(levelPack);
+        Array<IPreviewBeatmapLevel*>* levels = levelCollection->get_beatmapLevelCollection()->get_beatmapLevels();
+        for(int j = 0; j < levels->Length(); j++)   {
+            index->addLevel(pack, to_utf8(csstrtostr(levels->values[j]->get_levelID())));
+        }
+    }
+    index->finish();
+
+    getLogger().info("Indexed %lu levels in %lu packs", (unsigned long) index->getLevelCount(), (unsigned long) index->getPackCount());
+    std::atomic_store(&currentIndex, std::shared_ptr<const LevelPackIndex>(std::move(index)));
+}
+
+bool findLevelPacks(std::string_view levelId, std::vector<LevelPack>& packs)  {
+    PROFILE_SCOPE(PACK_LOOKUP);
+    std::shared_ptr<const LevelPackIndex> index = std::atomic_load(&currentIndex);
+    if(!index)  {return false;}
+
+    index->forEachPack(levelId, [&packs](const LevelPack& pack) {
+        packs.push_back(pack);
+    });
+    return true;
+}
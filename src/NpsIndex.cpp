@@ -0,0 +1,106 @@
+#include "NpsIndex.hpp"
+#include "Hash.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint64_t hashDifficultyKey(std::string_view levelId, std::string_view characteristic, int difficulty)   {
+    uint64_t hash = hashString(levelId);
+    hash = hashString("/", hash);
+    hash = hashString(characteristic, hash);
+    hash = hashString("/", hash);
+    char difficultyChar = (char) ('0' + difficulty);
+    return hashString(std::string_view(&difficultyChar, 1), hash);
+}
+
+uint64_t hashLevelId(std::string_view levelId) {
+    return hashString(levelId);
+}
+
+std::shared_ptr<const NpsIndex> NpsIndex::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)  {return nullptr;}
+
+    struct stat fileInfo;
+    if(fstat(fd, &fileInfo) != 0 || (size_t) fileInfo.st_size < sizeof(Header))  {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t length = fileInfo.st_size;
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid after the file is closed
+    if(mapping == MAP_FAILED)   {return nullptr;}
+
+    std::shared_ptr<NpsIndex> index(new NpsIndex());
+    index->mapping = mapping;
+    index->mappingLength = length;
+
+    // Make sure that the header matches, and that the file is long enough for the counts in it
+    const Header* header = reinterpret_cast<const Header*>(mapping);
+    size_t expectedLength = sizeof(Header) + (size_t) header->entryCount * sizeof(NpsIndexEntry) + (size_t) header->levelCount * sizeof(uint64_t);
+    if(header->magic != MAGIC || header->version != VERSION || length < expectedLength)    {
+        return nullptr;
+    }
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(mapping) + sizeof(Header);
+    index->entries = reinterpret_cast<const NpsIndexEntry*>(data);
+    index->entryCount = header->entryCount;
+    index->levels = reinterpret_cast<const uint64_t*>(data + header->entryCount * sizeof(NpsIndexEntry));
+    index->levelCount = header->levelCount;
+    index->densityWindow = header->densityWindow;
+    index->densityPercentile = header->densityPercentile;
+    return index;
+}
+
+bool NpsIndex::write(const std::string& path, std::vector<NpsIndexEntry> entries, std::vector<uint64_t> levels, float densityWindow, float densityPercentile)   {
+    // Sort by key, keeping only the last entry for each key so that newer results replace older ones
+    std::stable_sort(entries.begin(), entries.end(), [](const NpsIndexEntry& a, const NpsIndexEntry& b) {
+        return a.key < b.key;
+    });
+    auto lastOfEach = std::unique(entries.rbegin(), entries.rend(), [](const NpsIndexEntry& a, const NpsIndexEntry& b) {
+        return a.key == b.key;
+    });
+    entries.erase(entries.begin(), lastOfEach.base());
+
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if(!file)   {return false;}
+
+    Header header = {MAGIC, VERSION, (uint32_t) entries.size(), (uint32_t) levels.size(), densityWindow, densityPercentile};
+    bool success = fwrite(&header, sizeof(Header), 1, file) == 1;
+    success &= fwrite(entries.data(), sizeof(NpsIndexEntry), entries.size(), file) == entries.size();
+    success &= fwrite(levels.data(), sizeof(uint64_t), levels.size(), file) == levels.size();
+    success &= fclose(file) == 0;
+
+    if(!success || rename(tempPath.c_str(), path.c_str()) != 0)  {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+NpsIndex::~NpsIndex()   {
+    if(mapping) {
+        munmap(mapping, mappingLength);
+    }
+}
+
+const NpsIndexEntry* NpsIndex::find(uint64_t key) const {
+    const NpsIndexEntry* found = std::lower_bound(entriesBegin(), entriesEnd(), key, [](const NpsIndexEntry& entry, uint64_t key) {
+        return entry.key < key;
+    });
+    return (found != entriesEnd() && found->key == key) ? found : nullptr;
+}
+
+bool NpsIndex::containsLevel(uint64_t levelHash) const  {
+    return std::binary_search(levelsBegin(), levelsEnd(), levelHash);
+}
@@ -0,0 +1,264 @@
+#include "NpsIndexer.hpp"
+#include "NpsIndex.hpp"
+#include "LevelFileReader.hpp"
+#include "DensityAnalyzer.hpp"
+#include "DecisionWorker.hpp"
+#include "main.hpp"
+
+#include "GlobalNamespace/IBeatmapLevelPack.hpp"
+#include "GlobalNamespace/IBeatmapLevelPackCollection.hpp"
+#include "GlobalNamespace/IAnnotatedBeatmapLevelCollection.hpp"
+#include "GlobalNamespace/IBeatmapLevelCollection.hpp"
+#include "GlobalNamespace/IPreviewBeatmapLevel.hpp"
+#include "GlobalNamespace/CustomPreviewBeatmapLevel.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Number of levels to index before the index file is rewritten, so that progress isn't lost if the game is closed
+static constexpr size_t LEVELS_PER_WRITE = 250;
+// Number of entries calculated on the main thread to collect before they are written to the index
+static constexpr size_t RECORDED_PER_WRITE = 16;
+
+// A custom level that needs to be indexed
+struct IndexJob {
+    std::string levelId;
+    std::string levelPath;
+    float songDuration; // From the preview level, may be 0 if the game hasn't found it yet
+    float densityWindow;
+    float densityPercentile;
+};
+
+static std::shared_ptr<const NpsIndex> currentIndex;
+
+// Guards everything below
+static std::mutex indexerMutex;
+static std::condition_variable jobsAvailable;
+static std::vector<IndexJob> pendingJobs;
+static std::unordered_set<uint64_t> queuedLevels; // Levels which have been queued, so that they don't get queued again
+static float queuedDensityWindow = 0.0f; // Density settings that the queued levels will be analyzed with
+static float queuedDensityPercentile = 0.0f;
+static std::vector<NpsIndexEntry> recordedEntries; // Entries calculated on the main thread that haven't been written yet
+static bool workerStarted = false;
+
+static std::string getIndexPath()   {
+    return getDataPath("nps-index.bin");
+}
+
+static std::shared_ptr<const NpsIndex> getIndex()   {
+    return std::atomic_load(&currentIndex);
+}
+
+void loadNpsIndex() {
+    std::shared_ptr<const NpsIndex> index = NpsIndex::open(getIndexPath());
+    if(index)   {
+        getLogger().info("Loaded NPS index with %lu difficulties", (unsigned long) (index->entriesEnd() - index->entriesBegin()));
+    }
+    std::atomic_store(&currentIndex, std::move(index));
+}
+
+// Merges the new entries with the current index, then writes and maps the result
+static void rebuildIndex(std::vector<NpsIndexEntry>& newEntries, std::vector<uint64_t>& newLevels, float densityWindow, float densityPercentile)   {
+    if(newEntries.empty() && newLevels.empty()) {return;}
+    std::shared_ptr<const NpsIndex> oldIndex = getIndex();
+
+    // If the density settings have changed, every level is being indexed again so the old entries are dropped
+    std::vector<NpsIndexEntry> entries;
+    std::vector<uint64_t> levels;
+    if(oldIndex && oldIndex->hasDensitySettings(densityWindow, densityPercentile))    {
+        entries.assign(oldIndex->entriesBegin(), oldIndex->entriesEnd());
+        levels.assign(oldIndex->levelsBegin(), oldIndex->levelsEnd());
+    }
+    // The new entries are added last, so they replace any old entries with the same key
+    entries.insert(entries.end(), newEntries.begin(), newEntries.end());
+    levels.insert(levels.end(), newLevels.begin(), newLevels.end());
+
+    std::string path = getIndexPath();
+    if(!NpsIndex::write(path, std::move(entries), std::move(levels), densityWindow, densityPercentile))   {
+        getLogger().error("Failed to write NPS index to %s", path.c_str());
+        return;
+    }
+
+    std::atomic_store(&currentIndex, NpsIndex::open(path));
+    // Decisions made before these difficulties were indexed fell back to the average NPS, or couldn't be made in the background at all
+    clearDecisions();
+    newEntries.clear();
+    newLevels.clear();
+}
+
+// Returns false if the level couldn't be read, e.g. because it is still downloading or its files are invalid
+static bool indexLevel(const IndexJob& job, DensityAnalyzer& analyzer, std::vector<NpsIndexEntry>& newEntries)  {
+    std::optional<LevelFileData> levelData = readLevelFiles(job.levelPath);
+    if(!levelData)  {
+        getLogger().warning("Failed to read level files for %s", job.levelId.c_str());
+        return false;
+    }
+
+    float duration = job.songDuration > 0 ? job.songDuration : levelData->songDuration;
+    if(duration <= 0)   {
+        getLogger().warning("Couldn't find the length of %s", job.levelId.c_str());
+        return false;
+    }
+
+    // The analyzer reuses its buffers, so analyzing each difficulty in turn doesn't allocate.
+    // Each difficulty has its own sorted note times, so a combined pass would still need a sweep and a window array per difficulty
+    for(const DifficultyNotes& difficulty : levelData->difficulties)   {
+        DensityResult density = analyzer.analyze(difficulty.noteTimes, duration);
+        newEntries.push_back(NpsIndexEntry {
+            hashDifficultyKey(job.levelId, difficulty.characteristic, difficulty.difficulty),
+            (uint32_t) difficulty.noteTimes.size(),
+            duration,
+            density.peakNotesPerSecond,
+            density.percentileNotesPerSecond
+        });
+    }
+    return true;
+}
+
+static void indexerThread() {
+    // Indexing is never urgent, so make sure that it doesn't compete with the game for CPU time
+    setpriority(PRIO_PROCESS, gettid(), 19);
+
+    std::vector<NpsIndexEntry> newEntries;
+    std::vector<uint64_t> newLevels;
+    std::optional<DensityAnalyzer> analyzer;
+    float densityWindow = 0.0f;
+    float densityPercentile = 0.0f;
+
+    std::unique_lock<std::mutex> lock(indexerMutex);
+    while(true) {
+        jobsAvailable.wait(lock, [] {return !pendingJobs.empty() || recordedEntries.size() >= RECORDED_PER_WRITE;});
+
+        std::vector<IndexJob> jobs;
+        jobs.swap(pendingJobs);
+        if(!jobs.empty())   {
+            getLogger().info("Indexing NPS of %lu levels . . .", (unsigned long) jobs.size());
+        }
+
+        for(const IndexJob& job : jobs) {
+            lock.unlock();
+            // Write what has been indexed so far if the density settings changed, since the index only stores one set of settings
+            if(!analyzer || job.densityWindow != densityWindow || job.densityPercentile != densityPercentile)   {
+                if(analyzer)    {
+                    rebuildIndex(newEntries, newLevels, densityWindow, densityPercentile);
+                }
+                densityWindow = job.densityWindow;
+                densityPercentile = job.densityPercentile;
+                analyzer.emplace(densityWindow, densityPercentile);
+            }
+
+            uint64_t levelHash = hashLevelId(job.levelId);
+            bool indexed = indexLevel(job, *analyzer, newEntries);
+            if(indexed) {
+                newLevels.push_back(levelHash);
+                if(newLevels.size() >= LEVELS_PER_WRITE)    {
+                    rebuildIndex(newEntries, newLevels, densityWindow, densityPercentile);
+                }
+            }
+            lock.lock();
+            // Only levels that were read are marked as indexed. Unqueue the others so that they are tried again when the packs next reload
+            if(!indexed)    {
+                queuedLevels.erase(levelHash);
+            }
+        }
+
+        // Write whatever is left, along with any entries calculated on the main thread
+        newEntries.insert(newEntries.end(), recordedEntries.begin(), recordedEntries.end());
+        recordedEntries.clear();
+        lock.unlock();
+        if(analyzer)    {
+            rebuildIndex(newEntries, newLevels, densityWindow, densityPercentile);
+        }   else    {
+            // Nothing has been indexed this session, so keep the settings of the existing index
+            std::shared_ptr<const NpsIndex> index = getIndex();
+            std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+            rebuildIndex(newEntries, newLevels, index ? index->getDensityWindow() : config->densityWindow, index ? index->getDensityPercentile() : config->densityPercentile);
+        }
+        lock.lock();
+    }
+}
+
+// Must be called with indexerMutex held
+static void startWorkerIfNecessary()   {
+    if(!workerStarted)  {
+        std::thread(indexerThread).detach();
+        workerStarted = true;
+    }
+}
+
+void updateNpsIndex(BeatmapLevelsModel* beatmapLevelsModel)    {
+    std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+    std::shared_ptr<const NpsIndex> index = getIndex();
+    std::vector<IndexJob> jobs;
+
+    std::lock_guard<std::mutex> lock(indexerMutex);
+    // If the density settings have changed, every level needs to be analyzed again
+    if(index && !index->hasDensitySettings(config->densityWindow, config->densityPercentile))   {
+        index = nullptr;
+    }
+    if(queuedDensityWindow != config->densityWindow || queuedDensityPercentile != config->densityPercentile)  {
+        queuedLevels.clear();
+        queuedDensityWindow = config->densityWindow;
+        queuedDensityPercentile = config->densityPercentile;
+    }
+
+    Array<IBeatmapLevelPack*>* levelPacks = beatmapLevelsModel->get_allLoadedBeatmapLevelPackCollection()->get_beatmapLevelPacks();
+    for(int i = 0; i < levelPacks->Length(); i++)   {
+        IAnnotatedBeatmapLevelCollection* levelCollection = reinterpret_cast<IAnnotatedBeatmapLevelCollection*>(levelPacks->values[i]);
+        Array<IPreviewBeatmapLevel*>* levels = levelCollection->get_beatmapLevelCollection()->get_beatmapLevels();
+
+        for(int j = 0; j < levels->Length(); j++)   {
+            IPreviewBeatmapLevel* level = levels->values[j];
+
+            // Only custom levels can be read from disk. Other levels are recorded when they are selected instead
+            Il2CppClass* levelClass = il2cpp_functions::object_get_class(reinterpret_cast<Il2CppObject*>(level));
+            if(!il2cpp_functions::class_is_assignable_from(classof(CustomPreviewBeatmapLevel*), levelClass))  {continue;}
+
+            // Custom level IDs contain the hash of the level, so a changed level gets a new ID and is indexed again
+            std::string levelId = to_utf8(csstrtostr(level->get_levelID()));
+            uint64_t levelHash = hashLevelId(levelId);
+            if((index && index->containsLevel(levelHash)) || !queuedLevels.insert(levelHash).second)  {continue;}
+
+            std::string levelPath = to_utf8(csstrtostr(reinterpret_cast<CustomPreviewBeatmapLevel*>(level)->get_customLevelPath()));
+            jobs.push_back(IndexJob {std::move(levelId), std::move(levelPath), level->get_songDuration(), config->densityWindow, config->densityPercentile});
+        }
+    }
+
+    if(jobs.empty())    {return;}
+    pendingJobs.insert(pendingJobs.end(), std::make_move_iterator(jobs.begin()), std::make_move_iterator(jobs.end()));
+
+    startWorkerIfNecessary();
+    jobsAvailable.notify_one();
+}
+
+std::optional<NpsIndexEntry> findIndexedDifficulty(std::string_view levelId, std::string_view characteristic, int difficulty)  {
+    std::shared_ptr<const NpsIndex> index = getIndex();
+    if(!index)  {return std::nullopt;}
+
+    const NpsIndexEntry* entry = index->find(hashDifficultyKey(levelId, characteristic, difficulty));
+    if(!entry || entry->duration <= 0)  {return std::nullopt;}
+
+    // Don't return density found with different settings to the current ones
+    NpsIndexEntry result = *entry;
+    std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+    if(!index->hasDensitySettings(config->densityWindow, config->densityPercentile))  {
+        result.peakNotesPerSecond = 0.0f;
+        result.percentileNotesPerSecond = 0.0f;
+    }
+    return result;
+}
+
+void recordNotesPerSecond(std::string_view levelId, std::string_view characteristic, int difficulty, int notesCount, float duration)  {
+    std::lock_guard<std::mutex> lock(indexerMutex);
+    // The density can't be found without reading the note times, so it is left as 0
+    recordedEntries.push_back(NpsIndexEntry {hashDifficultyKey(levelId, characteristic, difficulty), (uint32_t) notesCount, duration, 0.0f, 0.0f});
+
+    startWorkerIfNecessary();
+    jobsAvailable.notify_one();
+}
@@ -0,0 +1,194 @@
+#include "PackMatcher.hpp"
+
+#include <algorithm>
+#include <map>
+
+// Stop compiling if the patterns would need a DFA larger than this, since globs with many wildcards can blow up
+static constexpr size_t MAX_DFA_STATES = 4096;
+
+static uint8_t toLowerCase(uint8_t c)   {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+namespace {
+    // Nondeterministic automaton for all of the patterns, which the DFA is built from
+    struct Nfa {
+        struct Transition {
+            uint8_t low;
+            uint8_t high;
+            uint32_t target;
+        };
+        struct State {
+            std::vector<Transition> transitions;
+            std::vector<uint32_t> epsilons;
+            bool accepting = false;
+        };
+
+        std::vector<State> states;
+        std::vector<uint32_t> starts;
+
+        uint32_t addState() {
+            states.emplace_back();
+            return states.size() - 1;
+        }
+
+        void addTransition(uint32_t from, uint8_t low, uint8_t high, uint32_t to)   {
+            states[from].transitions.push_back(Transition {low, high, to});
+        }
+
+        // Adds a path from the state matching any one UTF-8 encoded character, returning the state at the end of it
+        uint32_t addAnyCharacter(uint32_t from) {
+            uint32_t end = addState();
+            addTransition(from, 0x00, 0x7F, end);
+
+            // Lead bytes of 2, 3 and 4 byte sequences, each followed by that many continuation bytes
+            constexpr uint8_t LEAD_LOW[] = {0xC0, 0xE0, 0xF0};
+            constexpr uint8_t LEAD_HIGH[] = {0xDF, 0xEF, 0xF7};
+            for(int length = 1; length <= 3; length++)  {
+                uint32_t current = addState();
+                addTransition(from, LEAD_LOW[length - 1], LEAD_HIGH[length - 1], current);
+                for(int i = 1; i < length; i++) {
+                    uint32_t next = addState();
+                    addTransition(current, 0x80, 0xBF, next);
+                    current = next;
+                }
+                addTransition(current, 0x80, 0xBF, end);
+            }
+            return end;
+        }
+
+        // Adds every state reachable through epsilons, leaving the set sorted
+        void close(std::vector<uint32_t>& set) const    {
+            std::vector<uint32_t> stack(set);
+            while(!stack.empty())   {
+                uint32_t state = stack.back();
+                stack.pop_back();
+                for(uint32_t next : states[state].epsilons) {
+                    if(std::find(set.begin(), set.end(), next) == set.end())    {
+                        set.push_back(next);
+                        stack.push_back(next);
+                    }
+                }
+            }
+            std::sort(set.begin(), set.end());
+        }
+    };
+}
+
+// Adds the pattern to the NFA, returning false if it is invalid
+static bool addPattern(Nfa& nfa, std::string_view pattern)   {
+    uint32_t current = nfa.addState();
+    nfa.starts.push_back(current);
+
+    for(size_t i = 0; i < pattern.length(); i++)    {
+        char c = pattern[i];
+        if(c == '*')    {
+            // Loop on any byte, then carry on with the rest of the pattern
+            uint32_t next = nfa.addState();
+            nfa.addTransition(current, 0x00, 0xFF, current);
+            nfa.states[current].epsilons.push_back(next);
+            current = next;
+        }   else if(c == '?')   {
+            current = nfa.addAnyCharacter(current);
+        }   else    {
+            if(c == '\\')   {
+                if(++i == pattern.length()) {return false;}
+                c = pattern[i];
+            }
+            uint8_t byte = toLowerCase(c);
+            uint32_t next = nfa.addState();
+            nfa.addTransition(current, byte, byte, next);
+            current = next;
+        }
+    }
+
+    nfa.states[current].accepting = true;
+    return true;
+}
+
+PackMatcher PackMatcher::compile(const std::vector<std::string>& patterns, std::vector<std::string>& errors)   {
+    PackMatcher matcher;
+    Nfa nfa;
+    for(const std::string& pattern : patterns)  {
+        if(pattern.empty() || !addPattern(nfa, pattern))   {
+            errors.push_back("Invalid playlist pattern \"" + pattern + "\"");
+            continue;
+        }
+        matcher.patterns.push_back(pattern);
+    }
+    if(matcher.patterns.empty())    {return matcher;}
+
+    // Split the bytes into classes at every boundary of every transition range
+    bool boundaries[257] = {};
+    for(const Nfa::State& state : nfa.states)   {
+        for(const Nfa::Transition& transition : state.transitions)  {
+            boundaries[transition.low] = true;
+            boundaries[transition.high + 1] = true;
+        }
+    }
+    std::vector<uint8_t> classBytes; // One byte from each class, used to find the class's transitions
+    for(int byte = 0; byte < 256; byte++)   {
+        if(byte == 0 || boundaries[byte])   {classBytes.push_back(byte);}
+        matcher.byteClasses[byte] = classBytes.size() - 1;
+    }
+    matcher.classCount = classBytes.size();
+
+    // Subset construction, where each DFA state is the set of NFA states that could be active
+    std::map<std::vector<uint32_t>, uint32_t> stateIds;
+    std::vector<std::vector<uint32_t>> stateSets;
+    auto findState = [&](std::vector<uint32_t> set) {
+        if(set.empty()) {return DEAD_STATE;}
+        auto [it, inserted] = stateIds.emplace(set, (uint32_t) stateSets.size());
+        if(inserted)    {stateSets.push_back(std::move(set));}
+        return it->second;
+    };
+
+    stateSets.emplace_back(); // The dead state
+    std::vector<uint32_t> start(nfa.starts);
+    nfa.close(start);
+    findState(std::move(start));
+
+    for(uint32_t dfaState = 0; dfaState < stateSets.size(); dfaState++) {
+        if(stateSets.size() > MAX_DFA_STATES)   {
+            errors.push_back("Playlist patterns are too complex, ignoring all of them");
+            return PackMatcher();
+        }
+
+        bool accepting = false;
+        for(uint32_t state : stateSets[dfaState])  {
+            accepting |= nfa.states[state].accepting;
+        }
+        matcher.accepting.push_back(accepting);
+
+        for(uint8_t byte : classBytes)  {
+            std::vector<uint32_t> next;
+            for(uint32_t state : stateSets[dfaState])  {
+                for(const Nfa::Transition& transition : nfa.states[state].transitions)  {
+                    if(byte >= transition.low && byte <= transition.high && std::find(next.begin(), next.end(), transition.target) == next.end())  {
+                        next.push_back(transition.target);
+                    }
+                }
+            }
+            nfa.close(next);
+            // The set is copied rather than referenced, since adding a state can reallocate stateSets
+            matcher.transitions.push_back(findState(std::move(next)));
+        }
+    }
+
+    return matcher;
+}
+
+bool PackMatcher::matches(std::string_view name) const  {
+    if(patterns.empty())    {return false;}
+
+    uint32_t state = START_STATE;
+    for(char c : name)  {
+        state = transitions[state * classCount + byteClasses[toLowerCase(c)]];
+        if(state == DEAD_STATE) {return false;}
+    }
+    return accepting[state];
+}
+
+bool PackMatcher::isPattern(std::string_view str)   {
+    return str.find_first_of("*?") != std::string_view::npos;
+}
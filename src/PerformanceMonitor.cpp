@@ -0,0 +1,107 @@
+#include "PerformanceMonitor.hpp"
+#include "DecisionWorker.hpp"
+#include "FrameTimeSampler.hpp"
+#include "NpsIndex.hpp"
+#include "main.hpp"
+
+#include "UnityEngine/Time.hpp"
+#include "UnityEngine/XR/XRDevice.hpp"
+
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Frames longer than this are pauses or loading rather than rendering, so they aren't sampled
+static constexpr float MAXIMUM_FRAME_TIME = 250.0f;
+// Used if the headset doesn't report its refresh rate
+static constexpr float DEFAULT_REFRESH_RATE = 72.0f;
+
+// Only accessed with std::atomic_load and std::atomic_store. Copied and replaced whenever a play is recorded
+static std::shared_ptr<const PerformanceProfile> currentProfile = std::make_shared<const PerformanceProfile>();
+// Stops two saves from writing the temporary file at the same time
+static std::mutex saveMutex;
+
+// Only used on the main thread
+static FrameTimeSampler sampler;
+static bool sampling = false;
+static uint64_t sampledKey = 0;
+static bool sampledDebrisReduced = false;
+static float sampledBudget = 0.0f;
+static float lastSongTime = 0.0f;
+
+static std::string getProfilePath() {
+    return getDataPath("performance-profile.bin");
+}
+
+void loadPerformanceProfile()   {
+    std::shared_ptr<const PerformanceProfile> profile = std::make_shared<const PerformanceProfile>(PerformanceProfile::read(getProfilePath()));
+    getLogger().info("Loaded performance profile with %lu difficulties", (unsigned long) profile->size());
+    std::atomic_store(&currentProfile, profile);
+}
+
+MeasuredPerformance findMeasuredPerformance(std::string_view levelId, std::string_view characteristic, int difficulty)   {
+    return std::atomic_load(&currentProfile)->getPerformance(hashDifficultyKey(levelId, characteristic, difficulty));
+}
+
+void startFrameTimeSampling(const DecisionKey& key, bool debrisReduced, const ConfigSnapshot& config)    {
+    sampling = config.adaptiveMode;
+    if(!sampling)   {return;}
+
+    if(config.frameTimeBudget > 0)  {
+        sampledBudget = config.frameTimeBudget;
+    }   else    {
+        float refreshRate = UnityEngine::XR::XRDevice::get_refreshRate();
+        sampledBudget = 1000.0f / (refreshRate > 0 ? refreshRate : DEFAULT_REFRESH_RATE);
+    }
+
+    sampledKey = hashDifficultyKey(key.levelId, key.characteristic, key.difficulty);
+    sampledDebrisReduced = debrisReduced;
+    lastSongTime = 0.0f;
+    sampler.reset(config.frameTimePercentile);
+}
+
+void stopFrameTimeSampling()    {
+    sampling = false;
+}
+
+void sampleFrameTime(float songTime)    {
+    if(!sampling)   {return;}
+
+    // The song time doesn't move while paused
+    bool playing = songTime > lastSongTime;
+    lastSongTime = songTime;
+    if(!playing)    {return;}
+
+    float frameTime = UnityEngine::Time::get_unscaledDeltaTime() * 1000.0f;
+    if(frameTime < MAXIMUM_FRAME_TIME)  {
+        sampler.addSample(frameTime);
+    }
+}
+
+// Saves whichever profile is newest once the lock is taken, so an older save can't overwrite a newer one
+static void saveProfile()   {
+    std::lock_guard<std::mutex> lock(saveMutex);
+    if(!std::atomic_load(&currentProfile)->write(getProfilePath()))    {
+        ASYNC_LOG_ERROR("Failed to save performance profile");
+    }
+}
+
+void finishFrameTimeSampling()  {
+    if(!sampling)   {return;}
+    sampling = false;
+
+    std::optional<float> frameTime = sampler.finish();
+    if(!frameTime)  {
+        ASYNC_LOG_INFO("Level was too short to measure frame times (%lu frames)", (unsigned long) sampler.getSampleCount());
+        return;
+    }
+    ASYNC_LOG_INFO("Measured frame time of %.2f ms, budget is %.2f ms%s", *frameTime, sampledBudget, sampledDebrisReduced ? " with debris reduced" : "");
+
+    std::shared_ptr<PerformanceProfile> profile = std::make_shared<PerformanceProfile>(*std::atomic_load(&currentProfile));
+    profile->record(sampledKey, *frameTime, sampledBudget, sampledDebrisReduced);
+    std::atomic_store(&currentProfile, std::shared_ptr<const PerformanceProfile>(std::move(profile)));
+
+    // The cached decisions used the old measurements
+    clearDecisions();
+    std::thread(saveProfile).detach();
+}
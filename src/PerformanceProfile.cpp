@@ -0,0 +1,84 @@
+#include "PerformanceProfile.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+// Finds the number of bytes between the current position and the end of the file
+static long getRemainingSize(FILE* file)    {
+    long position = ftell(file);
+    if(position < 0 || fseek(file, 0, SEEK_END) != 0)   {return -1;}
+    long end = ftell(file);
+    if(end < 0 || fseek(file, position, SEEK_SET) != 0)   {return -1;}
+    return end - position;
+}
+
+PerformanceProfile PerformanceProfile::read(const std::string& path)   {
+    PerformanceProfile profile;
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file)   {return profile;}
+
+    Header header;
+    if(fread(&header, sizeof(Header), 1, file) == 1 && header.magic == MAGIC && header.version == VERSION)  {
+        // A corrupted entry count could be billions, so the profile is discarded rather than resized if the file is too short to hold it
+        long remainingSize = getRemainingSize(file);
+        if(remainingSize >= 0 && (uint64_t) header.entryCount * sizeof(PerformanceEntry) <= (uint64_t) remainingSize)   {
+            profile.entries.resize(header.entryCount);
+            if(fread(profile.entries.data(), sizeof(PerformanceEntry), header.entryCount, file) != header.entryCount)    {
+                profile.entries.clear();
+            }
+        }
+    }
+    fclose(file);
+
+    // A profile that isn't sorted was corrupted, and would break the binary search
+    if(!std::is_sorted(profile.entries.begin(), profile.entries.end(), [](const PerformanceEntry& a, const PerformanceEntry& b) {return a.key < b.key;}))   {
+        profile.entries.clear();
+    }
+    return profile;
+}
+
+bool PerformanceProfile::write(const std::string& path) const   {
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if(!file)   {return false;}
+
+    Header header = {MAGIC, VERSION, (uint32_t) entries.size(), 0};
+    bool success = fwrite(&header, sizeof(Header), 1, file) == 1;
+    success &= fwrite(entries.data(), sizeof(PerformanceEntry), entries.size(), file) == entries.size();
+    success &= fclose(file) == 0;
+
+    if(!success || rename(tempPath.c_str(), path.c_str()) != 0)  {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+const PerformanceEntry* PerformanceProfile::find(uint64_t key) const {
+    auto found = std::lower_bound(entries.begin(), entries.end(), key, [](const PerformanceEntry& entry, uint64_t key) {
+        return entry.key < key;
+    });
+    return (found != entries.end() && found->key == key) ? &*found : nullptr;
+}
+
+MeasuredPerformance PerformanceProfile::getPerformance(uint64_t key) const   {
+    const PerformanceEntry* entry = find(key);
+    return entry ? entry->performance : MeasuredPerformance::UNKNOWN;
+}
+
+void PerformanceProfile::record(uint64_t key, float frameTime, float budget, bool debrisReduced)    {
+    auto found = std::lower_bound(entries.begin(), entries.end(), key, [](const PerformanceEntry& entry, uint64_t key) {
+        return entry.key < key;
+    });
+    if(found == entries.end() || found->key != key) {
+        found = entries.insert(found, PerformanceEntry {key, 0.0f, 0.0f, MeasuredPerformance::UNKNOWN, {}});
+    }
+
+    found->frameTime = frameTime;
+    found->budget = budget;
+    if(frameTime > budget)  {
+        found->performance = MeasuredPerformance::OVER_BUDGET;
+    }   else if(!debrisReduced)    {
+        found->performance = MeasuredPerformance::WITHIN_BUDGET;
+    }
+}
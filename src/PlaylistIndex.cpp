@@ -0,0 +1,32 @@
+#include "PlaylistIndex.hpp"
+
+void PlaylistIndex::insertInto(StringSet& set, std::string_view value) {
+    if(value.empty() || set.find(value) != set.end()) {return;}
+
+    std::shared_ptr<const std::string> stored = std::make_shared<const std::string>(value);
+    set.emplace(std::string_view(*stored), std::move(stored));
+}
+
+void PlaylistIndex::insertInto(StringSet& set, const std::shared_ptr<const std::string>& value) {
+    if(!value || value->empty() || set.find(*value) != set.end()) {return;}
+    set.emplace(std::string_view(*value), value);
+}
+
+void PlaylistIndex::insert(const std::shared_ptr<const std::string>& packId, const std::shared_ptr<const std::string>& packName)  {
+    insertInto(ids, packId);
+    insertInto(names, packName);
+}
+
+void PlaylistIndex::insert(std::string_view packId, std::string_view packName)  {
+    insertInto(ids, packId);
+    insertInto(names, packName);
+}
+
+void PlaylistIndex::erase(std::string_view packId, std::string_view packName)   {
+    if(!packId.empty()) {ids.erase(packId);}
+    if(!packName.empty()) {names.erase(packName);}
+}
+
+bool PlaylistIndex::contains(std::string_view packId, std::string_view packName) const  {
+    return (!packId.empty() && ids.find(packId) != ids.end()) || (!packName.empty() && names.find(packName) != names.end());
+}
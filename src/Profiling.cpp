@@ -0,0 +1,145 @@
+#include "Profiling.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+std::atomic<bool> ProfilingInternal::enabled = false;
+
+static LatencyHistogram histograms[(int) ProfilePoint::COUNT];
+
+const char* profilePointToString(ProfilePoint point)    {
+    switch(point)   {
+        case ProfilePoint::REFRESH_CONTENT:
+            return "RefreshContent";
+        case ProfilePoint::START_STANDARD_LEVEL:
+            return "StartStandardLevel";
+        case ProfilePoint::START_MULTIPLAYER_LEVEL:
+            return "StartMultiplayerLevel";
+        case ProfilePoint::CONFIG_READ:
+            return "Config read";
+        case ProfilePoint::AUDIO_LENGTH:
+            return "Audio length";
+        case ProfilePoint::BEATMAP_DATA:
+            return "Beatmap data";
+        case ProfilePoint::PACK_LOOKUP:
+            return "Pack lookup";
+        default:
+            return "Unknown";
+    }
+}
+
+int LatencyHistogram::getBucketIndex(uint64_t value)    {
+    // Small values get a bucket each
+    if(value < SUB_BUCKET_COUNT)    {
+        return (int) value;
+    }
+
+    // Otherwise, the bucket is chosen by the highest set bit, and the sub-bucket by the bits after it
+    int magnitude = 63 - __builtin_clzll(value);
+    int subBucket = (int) ((value >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+    return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+uint64_t LatencyHistogram::getBucketValue(int index)    {
+    if(index < SUB_BUCKET_COUNT)    {
+        return index;
+    }
+
+    int magnitude = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = index % SUB_BUCKET_COUNT;
+    uint64_t lowest = (1ULL << magnitude) | (subBucket << (magnitude - SUB_BUCKET_BITS));
+    return lowest + (1ULL << (magnitude - SUB_BUCKET_BITS)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    buckets[getBucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t currentMax = max.load(std::memory_order_relaxed);
+    while(nanoseconds > currentMax && !max.compare_exchange_weak(currentMax, nanoseconds, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset()  {
+    for(std::atomic<uint64_t>& bucket : buckets)    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getMax() const   {
+    return max.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMean() const    {
+    uint64_t samples = getCount();
+    return samples == 0 ? 0.0 : (double) sum.load(std::memory_order_relaxed) / samples;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const   {
+    uint64_t samples = getCount();
+    if(samples == 0)    {return 0;}
+
+    // Find the first bucket where the running total reaches the target count
+    uint64_t target = (uint64_t) (percentile / 100.0 * samples + 0.5);
+    if(target == 0) {target = 1;}
+
+    uint64_t total = 0;
+    for(int i = 0; i < BUCKET_COUNT; i++)   {
+        total += buckets[i].load(std::memory_order_relaxed);
+        if(total >= target) {
+            return std::min(getBucketValue(i), getMax());
+        }
+    }
+    return getMax();
+}
+
+void setProfilingEnabled(bool enabled)  {
+    ProfilingInternal::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+LatencyHistogram& getHistogram(ProfilePoint point)  {
+    return histograms[(int) point];
+}
+
+std::string getProfilingSummary()   {
+    std::string summary = "Point                    count      mean       p50       p90       p99       max (microseconds)\n";
+    for(int i = 0; i < (int) ProfilePoint::COUNT; i++)  {
+        const LatencyHistogram& histogram = histograms[i];
+        if(histogram.getCount() == 0)   {continue;}
+
+        char line[192];
+        snprintf(line, sizeof(line), "%-22s %7llu %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+            profilePointToString((ProfilePoint) i),
+            (unsigned long long) histogram.getCount(),
+            histogram.getMean() / 1000.0,
+            histogram.getPercentile(50) / 1000.0,
+            histogram.getPercentile(90) / 1000.0,
+            histogram.getPercentile(99) / 1000.0,
+            histogram.getMax() / 1000.0
+        );
+        summary += line;
+    }
+    return summary;
+}
+
+void resetProfiling()   {
+    for(LatencyHistogram& histogram : histograms)   {
+        histogram.reset();
+    }
+}
+
+bool writeProfilingSummary(const std::string& path)    {
+    FILE* file = fopen(path.c_str(), "w");
+    if(!file)   {return false;}
+
+    std::string summary = getProfilingSummary();
+    bool success = fwrite(summary.data(), 1, summary.size(), file) == summary.size();
+    return fclose(file) == 0 && success;
+}
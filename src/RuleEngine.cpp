@@ -0,0 +1,133 @@
+#include "RuleEngine.hpp"
+#include "Difficulty.hpp"
+#include "Hash.hpp"
+
+#include <algorithm>
+
+static std::optional<RuleField> parseField(std::string_view name)   {
+    if(name == "nps") {return RuleField::NPS;}
+    if(name == "peakNps") {return RuleField::PEAK_NPS;}
+    if(name == "duration") {return RuleField::DURATION;}
+    if(name == "difficulty") {return RuleField::DIFFICULTY;}
+    if(name == "characteristic") {return RuleField::CHARACTERISTIC;}
+    if(name == "pack") {return RuleField::PACK;}
+    return std::nullopt;
+}
+
+RuleSet RuleSet::compile(const std::vector<RuleDefinition>& definitions, std::vector<std::string>& errors)  {
+    constexpr std::string_view OP_NAMES[] = {"<", "<=", ">", ">=", "==", "!="};
+
+    RuleSet ruleSet;
+    ruleSet.definitions = definitions;
+    for(const RuleDefinition& definition : definitions) {
+        Rule rule {(uint32_t) ruleSet.conditions.size(), 0, definition.override};
+        uint32_t ruleFields = 0;
+        bool valid = true;
+
+        for(const ConditionDefinition& conditionDefinition : definition.conditions) {
+            std::optional<RuleField> field = parseField(conditionDefinition.field);
+            if(!field)  {
+                errors.push_back("Rule \"" + definition.name + "\": unknown field \"" + conditionDefinition.field + "\"");
+                valid = false;
+                break;
+            }
+
+            int opIndex = 0;
+            while(opIndex < 6 && OP_NAMES[opIndex] != conditionDefinition.op) {opIndex++;}
+            if(opIndex == 6)    {
+                errors.push_back("Rule \"" + definition.name + "\": unknown operator \"" + conditionDefinition.op + "\"");
+                valid = false;
+                break;
+            }
+
+            Condition condition {*field, (Op) opIndex, 0.0f, 0};
+            if(*field == RuleField::CHARACTERISTIC || *field == RuleField::PACK)    {
+                // These can only be compared for equality, using the hash of the value
+                if(conditionDefinition.isNumber || (condition.op != Op::EQUAL && condition.op != Op::NOT_EQUAL))   {
+                    errors.push_back("Rule \"" + definition.name + "\": " + conditionDefinition.field + " must be compared to a string with == or !=");
+                    valid = false;
+                    break;
+                }
+                condition.hash = hashString(conditionDefinition.stringValue);
+            }   else if(*field == RuleField::DIFFICULTY && !conditionDefinition.isNumber)   {
+                std::optional<int> difficulty = parseDifficultyName(conditionDefinition.stringValue);
+                if(!difficulty) {
+                    errors.push_back("Rule \"" + definition.name + "\": unknown difficulty \"" + conditionDefinition.stringValue + "\"");
+                    valid = false;
+                    break;
+                }
+                condition.number = *difficulty;
+            }   else if(conditionDefinition.isNumber)   {
+                condition.number = conditionDefinition.numberValue;
+            }   else    {
+                errors.push_back("Rule \"" + definition.name + "\": " + conditionDefinition.field + " must be compared to a number");
+                valid = false;
+                break;
+            }
+
+            ruleSet.conditions.push_back(condition);
+            ruleFields |= 1u << (int) *field;
+        }
+
+        if(!valid)  {
+            ruleSet.conditions.resize(rule.firstCondition);
+            continue;
+        }
+
+        rule.conditionCount = (uint32_t) ruleSet.conditions.size() - rule.firstCondition;
+        ruleSet.rules.push_back(rule);
+        ruleSet.names.push_back(definition.name);
+        ruleSet.usedFields |= ruleFields;
+    }
+
+    return ruleSet;
+}
+
+bool RuleSet::compare(float value, float target, Op op)   {
+    switch(op)  {
+        case Op::LESS: return value < target;
+        case Op::LESS_EQUAL: return value <= target;
+        case Op::GREATER: return value > target;
+        case Op::GREATER_EQUAL: return value >= target;
+        case Op::EQUAL: return value == target;
+        case Op::NOT_EQUAL: return value != target;
+    }
+    return false;
+}
+
+bool RuleSet::evaluateCondition(const Condition& condition, const RuleInputs& inputs)  {
+    switch(condition.field) {
+        case RuleField::NPS:
+            return compare(inputs.notesPerSecond, condition.number, condition.op);
+        case RuleField::PEAK_NPS:
+            return inputs.peakNotesPerSecond >= 0 && compare(inputs.peakNotesPerSecond, condition.number, condition.op);
+        case RuleField::DURATION:
+            return compare(inputs.duration, condition.number, condition.op);
+        case RuleField::DIFFICULTY:
+            return compare((float) inputs.difficulty, condition.number, condition.op);
+        case RuleField::CHARACTERISTIC:
+            return (inputs.characteristicHash == condition.hash) == (condition.op == Op::EQUAL);
+        case RuleField::PACK: {
+            const uint64_t* packHashesEnd = inputs.packHashes + inputs.packHashCount;
+            bool inPack = std::find(inputs.packHashes, packHashesEnd, condition.hash) != packHashesEnd;
+            return inPack == (condition.op == Op::EQUAL);
+        }
+    }
+    return false;
+}
+
+int RuleSet::evaluate(const RuleInputs& inputs) const   {
+    for(size_t i = 0; i < rules.size(); i++)    {
+        const Rule& rule = rules[i];
+        const Condition* condition = conditions.data() + rule.firstCondition;
+        const Condition* end = condition + rule.conditionCount;
+
+        while(condition < end && evaluateCondition(*condition, inputs))  {
+            condition++;
+        }
+        if(condition == end)    {
+            return (int) i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,113 @@
+#include "SettingsOverride.hpp"
+#include "main.hpp"
+#include "AsyncLog.hpp"
+
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Same as FIELD_ATTRIBUTE_STATIC in il2cpp
+static constexpr uint16_t STATIC_FIELD_FLAG = 0x0010;
+
+// A field of PlayerSpecificSettings that can be overridden from the config
+template<typename T>
+struct SettingsField {
+    std::string_view name;
+    T PlayerSpecificSettings::* member;
+    OverrideField override;
+};
+
+// The overridable fields. The rest of the fields are copied generically, using the offsets from il2cpp's metadata
+static constexpr auto SETTINGS_FIELDS = std::make_tuple(
+    SettingsField<bool> {"reduceDebris", &PlayerSpecificSettings::reduceDebris, OverrideField::REDUCE_DEBRIS},
+    SettingsField<float> {"saberTrailIntensity", &PlayerSpecificSettings::saberTrailIntensity, OverrideField::SABER_TRAIL_INTENSITY},
+    SettingsField<bool> {"hideNoteSpawnEffect", &PlayerSpecificSettings::hideNoteSpawnEffect, OverrideField::HIDE_NOTE_SPAWN_EFFECT},
+    SettingsField<bool> {"noTextsAndHuds", &PlayerSpecificSettings::noTextsAndHuds, OverrideField::NO_TEXTS_AND_HUDS},
+    SettingsField<bool> {"noFailEffects", &PlayerSpecificSettings::noFailEffects, OverrideField::NO_FAIL_EFFECTS}
+);
+
+template<typename F>
+static constexpr void forEachSettingsField(F&& f)   {
+    std::apply([&](const auto&... fields) {(f(fields), ...);}, SETTINGS_FIELDS);
+}
+
+// Makes sure that every overridable field is in the table under the same name as in the config
+static constexpr bool checkOverrideFields()  {
+    size_t found = 0;
+    bool namesMatch = true;
+    forEachSettingsField([&](const auto& field) {
+        found++;
+        namesMatch &= field.name == OVERRIDE_FIELD_NAMES[(size_t) field.override];
+    });
+    return namesMatch && found == (size_t) OverrideField::COUNT;
+}
+static_assert(checkOverrideFields(), "Every override field needs exactly one entry in SETTINGS_FIELDS with a matching name");
+
+// Bytes of one instance field, relative to the start of the object
+struct FieldSpan {
+    uint32_t offset;
+    uint32_t size;
+};
+
+// Every value type instance field of PlayerSpecificSettings, so that fields added by a game update are copied without changing the mod
+static std::vector<FieldSpan> copiedFields;
+static bool settingsFieldsFound = false;
+
+// Created the first time a level is overridden, then reused for every level after
+static PlayerSpecificSettings* pooledSettings = nullptr;
+
+PlayerSpecificSettings* overrideSettings(PlayerSpecificSettings* settings, const ConfigSnapshot& config, std::optional<bool> reduceDebris)   {
+    if(!pooledSettings) {
+        pooledSettings = PlayerSpecificSettings::New_ctor();
+        // Nothing in the game references the copy while in the menu, so stop it from being garbage collected
+        il2cpp_functions::gchandle_new(reinterpret_cast<Il2CppObject*>(pooledSettings), false);
+    }
+
+    // Copy every field, then change the overridden ones
+    if(!settingsFieldsFound)    {findSettingsFields();}
+    uint8_t* source = reinterpret_cast<uint8_t*>(settings);
+    uint8_t* destination = reinterpret_cast<uint8_t*>(pooledSettings);
+    for(const FieldSpan& span : copiedFields)   {
+        std::memcpy(destination + span.offset, source + span.offset, span.size);
+    }
+
+    OverrideSet overrides = config.overrideFields;
+    overrides.set(OverrideField::REDUCE_DEBRIS, reduceDebris.value_or(config.mode == Mode::ENABLE) ? 1.0f : 0.0f);
+
+    forEachSettingsField([&](const auto& field) {
+        using T = std::remove_reference_t<decltype(settings->*field.member)>;
+        std::optional<float> value = overrides.get(field.override);
+        if(value)   {
+            pooledSettings->*field.member = (T) *value;
+        }
+
+        if(pooledSettings->*field.member != settings->*field.member)   {
+            ASYNC_LOG_INFO("Overriding %s", field.name.data());
+        }
+    });
+
+    return pooledSettings;
+}
+
+void findSettingsFields()  {
+    settingsFieldsFound = true;
+    copiedFields.clear();
+
+    Il2CppClass* settingsClass = classof(PlayerSpecificSettings*);
+    void* iter = nullptr;
+    while(FieldInfo* fieldInfo = il2cpp_functions::class_get_fields(settingsClass, &iter))  {
+        if(il2cpp_functions::field_get_flags(fieldInfo) & STATIC_FIELD_FLAG)  {continue;}
+
+        // Reference fields would need the GC to know about the copy, and the settings haven't had any so far
+        Il2CppClass* fieldClass = il2cpp_functions::class_from_type(il2cpp_functions::field_get_type(fieldInfo));
+        if(!il2cpp_functions::class_is_valuetype(fieldClass))   {
+            getLogger().warning("PlayerSpecificSettings field %s is a reference, so it isn't copied when overriding", il2cpp_functions::field_get_name(fieldInfo));
+            continue;
+        }
+
+        uint32_t size = il2cpp_functions::class_value_size(fieldClass, nullptr);
+        copiedFields.push_back(FieldSpan {(uint32_t) il2cpp_functions::field_get_offset(fieldInfo), size});
+    }
+    getLogger().info("Copying %lu PlayerSpecificSettings fields when overriding", (unsigned long) copiedFields.size());
+}
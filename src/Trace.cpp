@@ -0,0 +1,416 @@
+#include "Trace.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+using namespace Trace;
+
+// The buffer is written to the file once it gets this large
+static constexpr size_t FLUSH_SIZE = 16 * 1024;
+
+template<typename T>
+static void writeValue(std::vector<uint8_t>& buffer, T value)  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+static void writeString(std::vector<uint8_t>& buffer, std::string_view str)   {
+    writeValue<uint32_t>(buffer, str.length());
+    buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+static void writeKey(std::vector<uint8_t>& buffer, const DecisionKey& key)  {
+    writeString(buffer, key.levelId);
+    writeString(buffer, key.characteristic);
+    writeValue<int32_t>(buffer, key.difficulty);
+}
+
+static void writeHeader(std::vector<uint8_t>& buffer, EventType type, uint64_t timestamp)  {
+    writeValue<uint8_t>(buffer, (uint8_t) type);
+    writeValue<uint64_t>(buffer, timestamp);
+}
+
+std::optional<float> RecordingInputSource::calculateNotesPerSecond()    {
+    std::optional<float> value = inner.calculateNotesPerSecond();
+    inputs.requested |= 1 << (int) Input::NPS;
+    if(value)   {
+        inputs.available |= 1 << (int) Input::NPS;
+        inputs.notesPerSecond = *value;
+    }
+    return value;
+}
+
+float RecordingInputSource::calculatePeakNotesPerSecond()   {
+    float value = inner.calculatePeakNotesPerSecond();
+    inputs.requested |= 1 << (int) Input::PEAK_NPS;
+    inputs.available |= 1 << (int) Input::PEAK_NPS;
+    inputs.peakNotesPerSecond = value;
+    return value;
+}
+
+std::optional<float> RecordingInputSource::calculateDuration()  {
+    std::optional<float> value = inner.calculateDuration();
+    inputs.requested |= 1 << (int) Input::DURATION;
+    if(value)   {
+        inputs.available |= 1 << (int) Input::DURATION;
+        inputs.duration = *value;
+    }
+    return value;
+}
+
+bool RecordingInputSource::findLevelPacks(std::vector<LevelPack>& packs)   {
+    size_t firstPack = packs.size();
+    bool found = inner.findLevelPacks(packs);
+    inputs.requested |= 1 << (int) Input::PACKS;
+    if(found)   {
+        inputs.available |= 1 << (int) Input::PACKS;
+        inputs.packs.assign(packs.begin() + firstPack, packs.end());
+    }
+    return found;
+}
+
+MeasuredPerformance RecordingInputSource::findMeasuredPerformance()  {
+    MeasuredPerformance value = inner.findMeasuredPerformance();
+    inputs.requested |= 1 << (int) Input::PERFORMANCE;
+    inputs.available |= 1 << (int) Input::PERFORMANCE;
+    inputs.performance = value;
+    return value;
+}
+
+Writer::~Writer()   {
+    flushLocked();
+    if(file)    {
+        fclose(file);
+    }
+}
+
+bool Writer::open(const std::string& path)  {
+    std::lock_guard<std::mutex> lock(mutex);
+    file = fopen(path.c_str(), "wb");
+    if(!file)   {return false;}
+    writeFailed = false;
+
+    writeValue<uint32_t>(buffer, MAGIC);
+    writeValue<uint32_t>(buffer, VERSION);
+    flushLocked();
+    return file != nullptr;
+}
+
+void Writer::writeConfig(uint64_t timestamp, const ConfigSnapshot& config)  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!file)   {return;}
+    writeHeader(buffer, EventType::CONFIG, timestamp);
+    writeValue<uint64_t>(buffer, config.generation);
+    writeValue<uint8_t>(buffer, config.mode);
+    writeValue<float>(buffer, config.notesPerSecondThreshold);
+    writeValue<uint8_t>(buffer, (uint8_t) config.densityMode);
+    writeValue<float>(buffer, config.densityWindow);
+    writeValue<float>(buffer, config.densityPercentile);
+    writeValue<uint8_t>(buffer, config.adaptiveMode);
+
+    // The level overrides are written as their hashes, since the IDs aren't kept
+    const std::vector<uint64_t>& levelHashes = config.levelOverrides->getHashes();
+    const std::vector<LevelOverride>& levelStates = config.levelOverrides->getStates();
+    writeValue<uint32_t>(buffer, levelHashes.size());
+    for(size_t i = 0; i < levelHashes.size(); i++)  {
+        writeValue<uint64_t>(buffer, levelHashes[i]);
+        writeValue<uint8_t>(buffer, (uint8_t) levelStates[i]);
+    }
+
+    // The sets are written as a count followed by the strings
+    std::vector<std::string_view> ids, names;
+    config.playlists->forEachId([&](std::string_view id) {ids.push_back(id);});
+    config.playlists->forEachName([&](std::string_view name) {names.push_back(name);});
+    for(const std::vector<std::string_view>* set : {&ids, &names})  {
+        writeValue<uint32_t>(buffer, set->size());
+        for(std::string_view str : *set) {writeString(buffer, str);}
+    }
+
+    const std::vector<std::string>& patterns = config.playlistPatterns->getPatterns();
+    writeValue<uint32_t>(buffer, patterns.size());
+    for(const std::string& pattern : patterns) {writeString(buffer, pattern);}
+
+    const std::vector<RuleDefinition>& rules = config.rules->getDefinitions();
+    writeValue<uint32_t>(buffer, rules.size());
+    for(const RuleDefinition& rule : rules) {
+        writeString(buffer, rule.name);
+        writeValue<uint8_t>(buffer, rule.override);
+        writeValue<uint32_t>(buffer, rule.conditions.size());
+        for(const ConditionDefinition& condition : rule.conditions)    {
+            writeString(buffer, condition.field);
+            writeString(buffer, condition.op);
+            writeString(buffer, condition.stringValue);
+            writeValue<float>(buffer, condition.numberValue);
+            writeValue<uint8_t>(buffer, condition.isNumber);
+        }
+    }
+    finishEvent();
+}
+
+void Writer::writeSelect(uint64_t timestamp, const DecisionKey& key)    {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!file)   {return;}
+    writeHeader(buffer, EventType::SELECT, timestamp);
+    writeKey(buffer, key);
+    finishEvent();
+}
+
+void Writer::writeLevelStart(uint64_t timestamp, const DecisionKey& key, bool multiplayer, bool willOverride)    {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!file)   {return;}
+    writeHeader(buffer, EventType::LEVEL_START, timestamp);
+    writeKey(buffer, key);
+    writeValue<uint8_t>(buffer, multiplayer);
+    writeValue<uint8_t>(buffer, willOverride);
+    // The game may be closed during the level, so don't leave the session in the buffer
+    flushLocked();
+}
+
+void Writer::writeDecide(uint64_t timestamp, const DecisionKey& key, uint64_t configGeneration, uint64_t latency, const Inputs& inputs, const std::optional<Decision>& decision)   {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!file)   {return;}
+    writeHeader(buffer, EventType::DECIDE, timestamp);
+    writeKey(buffer, key);
+    writeValue<uint64_t>(buffer, configGeneration);
+    writeValue<uint64_t>(buffer, latency);
+
+    writeValue<uint8_t>(buffer, inputs.requested);
+    writeValue<uint8_t>(buffer, inputs.available);
+    writeValue<float>(buffer, inputs.notesPerSecond);
+    writeValue<float>(buffer, inputs.peakNotesPerSecond);
+    writeValue<float>(buffer, inputs.duration);
+    writeValue<uint32_t>(buffer, inputs.packs.size());
+    for(const LevelPack& pack : inputs.packs)   {
+        writeString(buffer, pack.id);
+        writeString(buffer, pack.name);
+    }
+    writeValue<uint8_t>(buffer, (uint8_t) inputs.performance);
+
+    writeValue<uint8_t>(buffer, decision.has_value());
+    if(decision)    {
+        writeValue<uint8_t>(buffer, decision->willOverride);
+        writeValue<uint8_t>(buffer, (uint8_t) decision->reason);
+        writeValue<int32_t>(buffer, decision->rule);
+    }
+    finishEvent();
+}
+
+void Writer::writeClearDecisions(uint64_t timestamp)    {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!file)   {return;}
+    writeHeader(buffer, EventType::CLEAR_DECISIONS, timestamp);
+    finishEvent();
+}
+
+void Writer::flush()    {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+void Writer::flushLocked()  {
+    if(!file || buffer.empty()) {return;}
+    bool success = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    success &= fflush(file) == 0;
+    buffer.clear();
+
+    // E.g. the storage is full. The file is closed, so that later events are dropped instead of piling up in the buffer
+    if(!success)    {
+        fclose(file);
+        file = nullptr;
+        writeFailed = true;
+    }
+}
+
+void Writer::finishEvent()  {
+    if(buffer.size() >= FLUSH_SIZE) {
+        flushLocked();
+    }
+}
+
+// Reads values from the trace, marking the reader as failed instead of reading past the end
+namespace {
+    struct Cursor {
+        const std::vector<uint8_t>& data;
+        size_t& position;
+        bool ok = true;
+
+        template<typename T>
+        T read()    {
+            T value{};
+            if(position + sizeof(T) > data.size())  {
+                ok = false;
+                return value;
+            }
+            std::memcpy(&value, data.data() + position, sizeof(T));
+            position += sizeof(T);
+            return value;
+        }
+
+        std::string readString()    {
+            uint32_t length = read<uint32_t>();
+            if(!ok || position + length > data.size())  {
+                ok = false;
+                return "";
+            }
+            std::string str(reinterpret_cast<const char*>(data.data() + position), length);
+            position += length;
+            return str;
+        }
+
+        // Reads the length of a list, failing if the rest of the trace is too short to hold it, so a corrupt length can't allocate too much
+        uint32_t readCount()    {
+            uint32_t count = read<uint32_t>();
+            if(ok && count > (data.size() - position) / sizeof(uint32_t))   {
+                ok = false;
+                return 0;
+            }
+            return count;
+        }
+
+        DecisionKey readKey()   {
+            DecisionKey key;
+            key.levelId = readString();
+            key.characteristic = readString();
+            key.difficulty = read<int32_t>();
+            return key;
+        }
+    };
+}
+
+bool Reader::open(const std::string& path)  {
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file)   {return false;}
+
+    uint8_t chunk[64 * 1024];
+    size_t read;
+    while((read = fread(chunk, 1, sizeof(chunk), file)) > 0)   {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+    fclose(file);
+
+    position = 0;
+    Cursor cursor {data, position};
+    if(cursor.read<uint32_t>() != MAGIC)    {return false;}
+    version = cursor.read<uint32_t>();
+    return cursor.ok && version >= 1 && version <= VERSION;
+}
+
+// Compiles the recorded config the same way as the config loader does
+static std::shared_ptr<const ConfigSnapshot> readConfig(Cursor& cursor, uint32_t version)    {
+    std::shared_ptr<ConfigSnapshot> config = std::make_shared<ConfigSnapshot>();
+    config->generation = cursor.read<uint64_t>();
+    config->mode = cursor.read<uint8_t>() ? Mode::ENABLE : Mode::DISABLE;
+    config->notesPerSecondThreshold = cursor.read<float>();
+    config->densityMode = (DensityMode) cursor.read<uint8_t>();
+    config->densityWindow = cursor.read<float>();
+    config->densityPercentile = cursor.read<float>();
+    if(version >= 2)    {
+        config->adaptiveMode = cursor.read<uint8_t>();
+    }
+    if(version >= 3)    {
+        std::shared_ptr<LevelOverrideList> levelOverrides = std::make_shared<LevelOverrideList>();
+        uint32_t levelCount = cursor.readCount();
+        for(uint32_t i = 0; i < levelCount && cursor.ok; i++)   {
+            uint64_t levelHash = cursor.read<uint64_t>();
+            levelOverrides->set(levelHash, (LevelOverride) cursor.read<uint8_t>());
+        }
+        config->levelOverrides = std::move(levelOverrides);
+    }
+
+    std::shared_ptr<PlaylistIndex> playlists = std::make_shared<PlaylistIndex>();
+    uint32_t idCount = cursor.readCount();
+    for(uint32_t i = 0; i < idCount && cursor.ok; i++)  {
+        playlists->insert(cursor.readString(), "");
+    }
+    uint32_t nameCount = cursor.readCount();
+    for(uint32_t i = 0; i < nameCount && cursor.ok; i++)    {
+        playlists->insert("", cursor.readString());
+    }
+    config->playlists = std::move(playlists);
+
+    std::vector<std::string> patterns(cursor.readCount());
+    for(size_t i = 0; i < patterns.size() && cursor.ok; i++)    {
+        patterns[i] = cursor.readString();
+    }
+
+    std::vector<RuleDefinition> rules(cursor.readCount());
+    for(size_t i = 0; i < rules.size() && cursor.ok; i++)   {
+        RuleDefinition& rule = rules[i];
+        rule.name = cursor.readString();
+        rule.override = cursor.read<uint8_t>();
+        rule.conditions.resize(cursor.readCount());
+        for(size_t j = 0; j < rule.conditions.size() && cursor.ok; j++) {
+            ConditionDefinition& condition = rule.conditions[j];
+            condition.field = cursor.readString();
+            condition.op = cursor.readString();
+            condition.stringValue = cursor.readString();
+            condition.numberValue = cursor.read<float>();
+            condition.isNumber = cursor.read<uint8_t>();
+        }
+    }
+
+    std::vector<std::string> errors;
+    config->playlistPatterns = std::make_shared<const PackMatcher>(PackMatcher::compile(patterns, errors));
+    config->rules = std::make_shared<const RuleSet>(RuleSet::compile(rules, errors));
+    return config;
+}
+
+bool Reader::next(Event& event) {
+    if(invalid || position >= data.size())  {return false;}
+
+    Cursor cursor {data, position};
+    event = Event {};
+    event.type = (EventType) cursor.read<uint8_t>();
+    event.timestamp = cursor.read<uint64_t>();
+
+    switch(event.type)  {
+        case EventType::CONFIG:
+            event.config = readConfig(cursor, version);
+            break;
+        case EventType::SELECT:
+            event.key = cursor.readKey();
+            break;
+        case EventType::LEVEL_START:
+            event.key = cursor.readKey();
+            event.multiplayer = cursor.read<uint8_t>();
+            event.willOverride = cursor.read<uint8_t>();
+            break;
+        case EventType::DECIDE: {
+            event.key = cursor.readKey();
+            event.configGeneration = cursor.read<uint64_t>();
+            event.latency = cursor.read<uint64_t>();
+
+            Inputs& inputs = event.inputs;
+            inputs.requested = cursor.read<uint8_t>();
+            inputs.available = cursor.read<uint8_t>();
+            inputs.notesPerSecond = cursor.read<float>();
+            inputs.peakNotesPerSecond = cursor.read<float>();
+            inputs.duration = cursor.read<float>();
+            inputs.packs.resize(cursor.readCount());
+            for(size_t i = 0; i < inputs.packs.size() && cursor.ok; i++)  {
+                inputs.packs[i].id = cursor.readString();
+                inputs.packs[i].name = cursor.readString();
+            }
+            if(version >= 2)    {
+                inputs.performance = (MeasuredPerformance) cursor.read<uint8_t>();
+            }
+
+            if(cursor.read<uint8_t>())  {
+                bool willOverride = cursor.read<uint8_t>();
+                OverrideReason reason = (OverrideReason) cursor.read<uint8_t>();
+                int rule = cursor.read<int32_t>();
+                event.decision = Decision {willOverride, reason, rule};
+            }
+            break;
+        }
+        case EventType::CLEAR_DECISIONS:
+            break;
+        default:
+            cursor.ok = false;
+            break;
+    }
+
+    invalid = !cursor.ok;
+    return cursor.ok;
+}
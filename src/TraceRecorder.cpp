@@ -0,0 +1,78 @@
+#include "TraceRecorder.hpp"
+#include "main.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+
+static Trace::Writer traceWriter;
+static std::atomic<bool> recording = false;
+static std::chrono::steady_clock::time_point recordingStart;
+
+static uint64_t getTimestamp()  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - recordingStart).count();
+}
+
+void startTraceRecording()  {
+    std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+    if(!config->traceRecording || recording)   {return;}
+
+    // Each session gets its own file, so that old traces aren't overwritten
+    std::string path = getDataPath("trace-" + std::to_string(time(nullptr)) + ".bin");
+    if(!traceWriter.open(path)) {
+        getLogger().error("Failed to open trace file %s", path.c_str());
+        return;
+    }
+    getLogger().info("Recording trace to %s", path.c_str());
+
+    recordingStart = std::chrono::steady_clock::now();
+    recording.store(true, std::memory_order_release);
+    // Later snapshots are recorded when they're published, but this one already has been
+    traceConfig(*config);
+}
+
+// Stops recording if the last events couldn't be written, e.g. because the storage is full
+static void checkTraceWriteFailed() {
+    if(traceWriter.failed() && recording.exchange(false))   {
+        ASYNC_LOG_WARNING("Failed to write to the trace file, stopping recording");
+    }
+}
+
+bool isTraceRecording() {
+    return recording.load(std::memory_order_relaxed);
+}
+
+void traceConfig(const ConfigSnapshot& config)  {
+    if(isTraceRecording())  {
+        traceWriter.writeConfig(getTimestamp(), config);
+        checkTraceWriteFailed();
+    }
+}
+
+void traceSelect(const DecisionKey& key)    {
+    if(isTraceRecording())  {
+        traceWriter.writeSelect(getTimestamp(), key);
+        checkTraceWriteFailed();
+    }
+}
+
+void traceLevelStart(const DecisionKey& key, bool multiplayer, bool willOverride)   {
+    if(isTraceRecording())  {
+        traceWriter.writeLevelStart(getTimestamp(), key, multiplayer, willOverride);
+        checkTraceWriteFailed();
+    }
+}
+
+void traceDecide(const DecisionKey& key, uint64_t configGeneration, uint64_t latency, const Trace::Inputs& inputs, const std::optional<Decision>& decision)  {
+    if(isTraceRecording())  {
+        traceWriter.writeDecide(getTimestamp(), key, configGeneration, latency, inputs, decision);
+        checkTraceWriteFailed();
+    }
+}
+
+void traceClearDecisions()  {
+    if(isTraceRecording())  {
+        traceWriter.writeClearDecisions(getTimestamp());
+        checkTraceWriteFailed();
+    }
+}
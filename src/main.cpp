@@ -1,5 +1,15 @@
 #include "main.hpp"
+#include "AsyncLog.hpp"
 #include "AutoDebrisViewController.hpp"
+#include "DecisionWorker.hpp"
+#include "DynamicDebris.hpp"
+#include "LevelOverrideButton.hpp"
+#include "LevelPacks.hpp"
+#include "NpsIndexer.hpp"
+#include "PerformanceMonitor.hpp"
+#include "Profiling.hpp"
+#include "SettingsOverride.hpp"
+#include "TraceRecorder.hpp"
 using namespace AutoDebris;
 
 #include "GlobalNamespace/StandardLevelScenesTransitionSetupDataSO.hpp"
@@ -10,30 +20,43 @@ using namespace AutoDebris;
 #include "GlobalNamespace/StandardLevelDetailView.hpp"
 #include "GlobalNamespace/LevelParamsPanel.hpp"
 #include "GlobalNamespace/BeatmapLevelData.hpp"
-#include "GlobalNamespace/IBeatmapLevelPack.hpp"
 #include "GlobalNamespace/IBeatmapLevel.hpp"
 #include "GlobalNamespace/BeatmapData.hpp"
 #include "GlobalNamespace/PlayerSpecificSettings.hpp"
 #include "GlobalNamespace/BeatmapDifficulty.hpp"
 #include "GlobalNamespace/BeatmapCharacteristicSO.hpp"
+#include "GlobalNamespace/IDifficultyBeatmapSet.hpp"
 #include "GlobalNamespace/BeatmapSelectionView.hpp"
 #include "GlobalNamespace/MenuTransitionsHelper.hpp"
+#include "GlobalNamespace/AudioTimeSyncController.hpp"
+#include "GlobalNamespace/NoteDebrisSpawner.hpp"
+#include "GlobalNamespace/ColorType.hpp"
 
 #include "UnityEngine/Resources.hpp"
 #include "UnityEngine/AudioClip.hpp"
+#include "UnityEngine/Vector3.hpp"
+#include "UnityEngine/Quaternion.hpp"
 #include "UnityEngine/SceneManagement/Scene.hpp"
 #include "UnityEngine/SceneManagement/SceneManager.hpp"
 
+#include "beatsaber-hook/shared/utils/utils.h"
+
 #include "questui/shared/QuestUI.hpp"
 #include "custom-types/shared/register.hpp"
 
 #include <optional>
 #include <unordered_set>
 
+#include <sys/stat.h>
+
 static ModInfo modInfo;
+const ModInfo& getModInfo()  {
+    return modInfo;
+}
+
+// Only the config thread and the settings UI should use this directly, everything else reads the config snapshot
 Configuration& getConfig() {
     static Configuration config(modInfo);
-    config.Load();
     return config;
 }
 
@@ -42,19 +65,31 @@ Logger& getLogger() {
     return *logger;
 }
 
-static Mode overrideMode; // Whether we are enabling or disabling reduce debris
+std::string getDataPath(std::string_view fileName)  {
+    static std::string dataDir = [] {
+        std::string dir = getDataDir(modInfo);
+        mkdir(dir.c_str(), 0777);
+        return dir;
+    }();
+
+    std::string path = dataDir;
+    if(!path.empty() && path.back() != '/') {path += '/';}
+    path += fileName;
+    return path;
+}
+
 Mode swapOverrideMode()  {
     // Find the opposite mode and set it back
-    Mode newMode = (Mode) !((bool) overrideMode);
-    overrideMode = newMode;
-
-    // Save the swapped value back to the config
-    getConfig().config["mode"].SetString(modeToString(overrideMode), getConfig().config.GetAllocator());
-    return overrideMode;
+    Mode newMode = (Mode) !((bool) getOverrideMode());
+    editConfig([newMode](ConfigSnapshot& config) {
+        config.mode = newMode;
+    });
+    return newMode;
 }
 
+// Whether we are enabling or disabling reduce debris
 Mode getOverrideMode()  {
-    return overrideMode;
+    return getConfigSnapshot()->mode;
 }
 
 // Convenience method for converting a mode to a string
@@ -62,84 +97,135 @@ std::string modeToString(Mode mode)  {
     return (mode == Mode::ENABLE) ? "enable" : "disable";
 }
 
-// Convenience method for checking the rapidjson array for this playlist name, since there is no contains method
-bool isPlaylistOverridden(std::string name) {
-    // Check if this playlist is in the overridden playlists list.
-    for(rapidjson::Value& value : getConfig().config["playlists"].GetArray())   {
-        if(value.GetString() == name)   {
-            return true;
+static DecisionKey makeDecisionKey(IBeatmapLevel* level, IDifficultyBeatmap* difficulty)  {
+    IPreviewBeatmapLevel* previewLevel = reinterpret_cast<IPreviewBeatmapLevel*>(level);
+    BeatmapCharacteristicSO* characteristic = difficulty->get_parentDifficultyBeatmapSet()->get_beatmapCharacteristic();
+
+    return DecisionKey {
+        to_utf8(csstrtostr(previewLevel->get_levelID())),
+        to_utf8(csstrtostr(characteristic->get_serializedName())),
+        (int) difficulty->get_difficulty()
+    };
+}
+
+// How long starting a level waits for the background decision before deciding on the main thread instead
+static constexpr std::chrono::milliseconds DECISION_WAIT_TIMEOUT(50);
+
+// Finds the inputs to the decision engine from the selected level. This uses the game, so it must only be used on the main thread
+class LevelInputSource : public DecisionInputSource {
+public:
+    LevelInputSource(const DecisionKey& key, IBeatmapLevel* level, IDifficultyBeatmap* difficulty) : key(key), level(level), difficulty(difficulty) {}
+
+    // If the difficulty hasn't been indexed yet, this has to load the audio and beatmap data of the level
+    std::optional<float> calculateNotesPerSecond() override    {
+        ASYNC_LOG_DEBUG("Checking NPS threshold . . .");
+        NpsIndexEntry stats = findDifficultyStats();
+        return stats.getNotesPerSecond();
+    }
+
+    std::optional<float> calculateDuration() override  {
+        return findDifficultyStats().duration;
+    }
+
+    // The density can only be found from the note times, which are only read by the indexer
+    float calculatePeakNotesPerSecond() override    {
+        ASYNC_LOG_DEBUG("Checking peak density . . .");
+        std::optional<NpsIndexEntry> indexed = findIndexedDifficulty(key.levelId, key.characteristic, key.difficulty);
+        if(indexed && indexed->percentileNotesPerSecond > 0)    {
+            return indexed->percentileNotesPerSecond;
+        }
+
+        ASYNC_LOG_DEBUG("Difficulty hasn't been analyzed yet, using average NPS instead");
+        return -1.0f;
+    }
+
+    bool findLevelPacks(std::vector<LevelPack>& packs) override {
+        ASYNC_LOG_DEBUG("Checking song playlists . . .");
+        // The index is built when the packs are loaded, so this should only need to build it if a level is somehow selected before then
+        if(!::findLevelPacks(key.levelId, packs))   {
+            updateLevelPacks(getBeatmapLevelsModel());
+            ::findLevelPacks(key.levelId, packs);
         }
+        return true;
+    }
+
+    MeasuredPerformance findMeasuredPerformance() override  {
+        return ::findMeasuredPerformance(key.levelId, key.characteristic, key.difficulty);
     }
-    return false; // Return false if the playlist wasn't found
-}
-
-static bool willOverride = false;
-
-// Copies all the player settings into a new settings object
-// Yes, I know this is a stupid way to do it
-PlayerSpecificSettings* cloneSettings(PlayerSpecificSettings* settings) {
-    PlayerSpecificSettings* clone = PlayerSpecificSettings::New_ctor();
-    clone->adaptiveSfx = settings->adaptiveSfx;
-    clone->advancedHud = settings->advancedHud;
-    clone->automaticPlayerHeight = settings->automaticPlayerHeight;
-    clone->autoRestart = settings->autoRestart;
-    clone->hideNoteSpawnEffect = settings->hideNoteSpawnEffect;
-    clone->leftHanded = settings->leftHanded;
-    clone->noFailEffects = settings->noFailEffects;
-    clone->noteJumpStartBeatOffset = settings->noteJumpStartBeatOffset;
-    clone->noTextsAndHuds = settings->noTextsAndHuds;
-    clone->playerHeight = settings->playerHeight;
-    clone->reduceDebris = settings->reduceDebris;
-    clone->saberTrailIntensity = settings->saberTrailIntensity;
-    clone->sfxVolume = settings->sfxVolume;
-    clone->environmentEffectsFilterDefaultPreset = settings->environmentEffectsFilterDefaultPreset;
-    clone->environmentEffectsFilterExpertPlusPreset = settings->environmentEffectsFilterExpertPlusPreset;
-    return clone;
-}
-
-void overrideIfNecessary(IBeatmapLevel* level, IDifficultyBeatmap* difficulty) {
-    // If the NPS threshold is enabled
-    float npsThreshold = getConfig().config["notesPerSecondThreshold"].GetFloat();
-    if(npsThreshold > 0)    {
-        getLogger().info("Checking NPS threshold . . .");
+
+private:
+    const DecisionKey& key;
+    IBeatmapLevel* level;
+    IDifficultyBeatmap* difficulty;
+
+    // Finds the note count and length of the difficulty from the index, or from the game if it isn't indexed
+    NpsIndexEntry findDifficultyStats()   {
+        std::optional<NpsIndexEntry> indexed = findIndexedDifficulty(key.levelId, key.characteristic, key.difficulty);
+        if(indexed)  {
+            return *indexed;
+        }
 
         // Find the length of the audio for the song
-        IBeatmapLevelData* levelData = level->get_beatmapLevelData();
-        UnityEngine::AudioClip* audioClip = levelData->get_audioClip();
-        float songLength = audioClip->get_length();
+        float songLength;
+        {
+            PROFILE_SCOPE(AUDIO_LENGTH);
+            IBeatmapLevelData* levelData = level->get_beatmapLevelData();
+            UnityEngine::AudioClip* audioClip = levelData->get_audioClip();
+            songLength = audioClip->get_length();
+        }
 
         // Find the number of notes
-        BeatmapData* beatmapData = difficulty->get_beatmapData();
-        int notesCount = beatmapData->get_cuttableNotesType();
+        int notesCount;
+        {
+            PROFILE_SCOPE(BEATMAP_DATA);
+            BeatmapData* beatmapData = difficulty->get_beatmapData();
+            notesCount = beatmapData->get_cuttableNotesType();
+        }
+        // Save the result so that the level doesn't need to be loaded next time
+        recordNotesPerSecond(key.levelId, key.characteristic, key.difficulty, notesCount, songLength);
 
-        // Find the notes per second
-        float nps = notesCount / songLength;
+        return NpsIndexEntry {0, (uint32_t) notesCount, songLength, 0.0f, 0.0f};
+    }
+};
 
-        // We either check if the NPS is greater or lesser depending on the mode
-        if((overrideMode == Mode::ENABLE && nps > npsThreshold) || (overrideMode == Mode::DISABLE && nps < npsThreshold))   {
-            getLogger().info("NPS below or above threshold, overriding . . .");
-            willOverride = true;
-            return;
-        }
+static void logDecision(const ConfigSnapshot& config, const Decision& decision) {
+    if(decision.reason == OverrideReason::RULE) {
+        ASYNC_LOG_INFO("Rule \"%s\" fired, %s", config.rules->getName(decision.rule).c_str(), decision.willOverride ? "overriding" : "not overriding");
+    }   else if(decision.willOverride)   {
+        ASYNC_LOG_INFO("Overriding because of %s", reasonToString(decision.reason));
     }
+}
 
-    // Check the song's playlist to see if we need to override
-    getLogger().info("Checking song playlist . . .");
+// Decides on the main thread, loading the level if its inputs aren't cached or indexed
+static Decision decideOnMainThread(IBeatmapLevel* level, IDifficultyBeatmap* difficulty, const DecisionKey& key) {
+    std::shared_ptr<const ConfigSnapshot> config;
+    {
+        PROFILE_SCOPE(CONFIG_READ);
+        config = getConfigSnapshot();
+    }
+    LevelInputSource inputs(key, level, difficulty);
 
-    // Reinterpret this level as an IPreviewBeatmapLevel, then find the level pack it is in
-    IPreviewBeatmapLevel* previewLevel = reinterpret_cast<IPreviewBeatmapLevel*>(level);
-    IBeatmapLevelPack* levelPack = getBeatmapLevelsModel()->GetLevelPackForLevelId(previewLevel->get_levelID());
-    // Find the pack name
-    std::string playlistName = to_utf8(csstrtostr(levelPack->get_packName()));
-
-    // If it is, override the setting
-    if(isPlaylistOverridden(playlistName)) {
-        getLogger().info("Playlist is set as overridden, overriding . . .");
-        willOverride = true;
-        return;
+    Decision decision = decideNow(*config, key, inputs);
+    logDecision(*config, decision);
+    return decision;
+}
+
+// Uses the background decision for the difficulty being started, deciding on the main thread if it isn't ready or couldn't be made
+static Decision decideOnLevelStart(IBeatmapLevel* level, IDifficultyBeatmap* difficulty, const DecisionKey& key) {
+    std::optional<Decision> decision = waitForDecision(key, DECISION_WAIT_TIMEOUT);
+    if(decision)    {
+        logDecision(*getConfigSnapshot(), *decision);
+    }   else    {
+        decision = decideOnMainThread(level, difficulty, key);
     }
 
-    willOverride = false;
+    traceLevelStart(key, false, decision->willOverride);
+    return *decision;
+}
+
+// Only overrides caused by the density of the level are limited to its dense parts, others reduce debris for the whole song
+static bool isDensityReason(OverrideReason reason)  {
+    return reason == OverrideReason::NPS_THRESHOLD || reason == OverrideReason::PEAK_DENSITY;
 }
 
 // Very large hook called when a level is starting
@@ -149,11 +235,30 @@ MAKE_HOOK_OFFSETLESS(MenuTransitionsHelper_StartStandardLevel, void, StandardLev
                     PlayerSpecificSettings* playerSpecificSettings, PracticeSettings* practiceSettings,
                     Il2CppString* backButtonText, bool useTestNoteCutSoundEffects, 
                     Il2CppObject* beforeSceneSwitchCallback, Il2CppObject* afterSceneSwitchCallback, Il2CppObject* levelFinishedCallback)    {    
-    // If we need to override the setting, make a new copy of the player settings and change it
-    if(willOverride)    {
-        getLogger().info("Overriding setting on level start . . .");
-        playerSpecificSettings = cloneSettings(playerSpecificSettings);
-        playerSpecificSettings->reduceDebris = overrideMode;
+    {
+        PROFILE_SCOPE(START_STANDARD_LEVEL);
+        IBeatmapLevel* level = difficultyBeatmap->get_level();
+        DecisionKey key = makeDecisionKey(level, difficultyBeatmap);
+        std::shared_ptr<const ConfigSnapshot> config = getConfigSnapshot();
+        bool debrisReduced = playerSpecificSettings->reduceDebris;
+        // If we need to override the setting, make a new copy of the player settings and change it
+        Decision decision = decideOnLevelStart(level, difficultyBeatmap, key);
+        if(decision.willOverride)    {
+            ASYNC_LOG_INFO("Overriding setting on level start . . .");
+            debrisReduced = config->mode == Mode::ENABLE;
+            // With dynamic debris, a level overridden for its density starts with debris on and the debris spawner hook reduces it in the dense parts.
+            // Playlist, rule, frame time and level overrides aren't about density, so they reduce debris for the whole song
+            if(isDensityReason(decision.reason) && startDynamicDebris(previewBeatmapLevel, key, *config))  {
+                playerSpecificSettings = overrideSettings(playerSpecificSettings, *config, false);
+            }   else    {
+                playerSpecificSettings = overrideSettings(playerSpecificSettings, *config);
+                stopDynamicDebris();
+            }
+        }   else    {
+            stopDynamicDebris();
+        }
+        // In adaptive mode, the frame times of the level are measured for the next time it is played
+        startFrameTimeSampling(key, debrisReduced, *config);
     }
 
     MenuTransitionsHelper_StartStandardLevel(self, gameMode, difficultyBeatmap, previewBeatmapLevel, overrideEnvironmentSettings, overrideColorScheme, gameplayModifiers, playerSpecificSettings, practiceSettings, backButtonText, useTestNoteCutSoundEffects, beforeSceneSwitchCallback, afterSceneSwitchCallback, levelFinishedCallback);
@@ -167,19 +272,59 @@ MAKE_HOOK_OFFSETLESS(MenuTransitionsHelper_StartMultiplayerLevel, void, MenuTran
                     PlayerSpecificSettings* playerSpecificSettings, Il2CppObject* practiceSettings,
                     Il2CppString* backButtonText, bool useTestNoteCutSoundEffects, Il2CppObject* beforeSceneSwitchCallback,
                     Il2CppObject* afterSceneSwitchCallback, Il2CppObject* levelFinishedCallback, Il2CppObject* didDisconnectCallback) {
-    overrideIfNecessary(difficultyBeatmap->get_level(), difficultyBeatmap);
-
-    // If we need to override the setting, make a new copy of the player settings and change it
-    if(willOverride)    {
-        getLogger().info("Overriding setting on level start . . .");
-        playerSpecificSettings = cloneSettings(playerSpecificSettings);
-        playerSpecificSettings->reduceDebris = overrideMode;
+    {
+        PROFILE_SCOPE(START_MULTIPLAYER_LEVEL);
+        // Multiplayer levels aren't selected through the level detail view, so there is no background decision to wait for
+        IBeatmapLevel* level = difficultyBeatmap->get_level();
+        DecisionKey key = makeDecisionKey(level, difficultyBeatmap);
+        bool willOverride = decideOnMainThread(level, difficultyBeatmap, key).willOverride;
+        traceLevelStart(key, true, willOverride);
+        // Multiplayer levels always override for the whole song, and aren't measured since other players affect the frame times
+        stopDynamicDebris();
+        stopFrameTimeSampling();
+
+        // If we need to override the setting, make a new copy of the player settings and change it
+        if(willOverride)    {
+            ASYNC_LOG_INFO("Overriding setting on level start . . .");
+            playerSpecificSettings = overrideSettings(playerSpecificSettings, *getConfigSnapshot());
+        }
     }
 
     
     MenuTransitionsHelper_StartMultiplayerLevel(self, gameMode, previewBeatmapLevel, beatmapDifficulty, beatmapCharacteristic, difficultyBeatmap, overrideColorScheme, gameplayModifiers, playerSpecificSettings, practiceSettings, backButtonText, useTestNoteCutSoundEffects, beforeSceneSwitchCallback, afterSceneSwitchCallback, levelFinishedCallback, didDisconnectCallback);
 }
 
+// The controller of the level being played, which the debris spawner hook gets the song time from
+static AudioTimeSyncController* audioTimeSyncController = nullptr;
+
+MAKE_HOOK_OFFSETLESS(AudioTimeSyncController_Start, void, AudioTimeSyncController* self)    {
+    AudioTimeSyncController_Start(self);
+    audioTimeSyncController = self;
+}
+
+MAKE_HOOK_OFFSETLESS(AudioTimeSyncController_Update, void, AudioTimeSyncController* self)    {
+    AudioTimeSyncController_Update(self);
+    sampleFrameTime(self->get_songTime());
+}
+
+// Called when a standard level finishes, whether it was cleared, failed or quit
+MAKE_HOOK_OFFSETLESS(MenuTransitionsHelper_HandleMainGameSceneDidFinish, void, MenuTransitionsHelper* self, StandardLevelScenesTransitionSetupDataSO* setupData, Il2CppObject* levelCompletionResults)  {
+    finishFrameTimeSampling();
+    // The controller is destroyed with the game scene, so it mustn't be used again until the next level starts one
+    audioTimeSyncController = nullptr;
+    stopDynamicDebris();
+    MenuTransitionsHelper_HandleMainGameSceneDidFinish(self, setupData, levelCompletionResults);
+}
+
+// Called for every cut note. With dynamic debris, the debris isn't spawned during the parts of the song where it is reduced
+MAKE_HOOK_OFFSETLESS(NoteDebrisSpawner_SpawnDebris, void, NoteDebrisSpawner* self, UnityEngine::Vector3 cutPoint, UnityEngine::Vector3 cutNormal,
+                    float saberSpeed, UnityEngine::Vector3 saberDir, UnityEngine::Vector3 notePos, UnityEngine::Quaternion noteRotation,
+                    ColorType colorType, float timeToNextColorNote, UnityEngine::Vector3 moveVec) {
+    if(isDynamicDebrisActive() && audioTimeSyncController && isDebrisReduced(audioTimeSyncController->get_songTime()))    {return;}
+
+    NoteDebrisSpawner_SpawnDebris(self, cutPoint, cutNormal, saberSpeed, saberDir, notePos, noteRotation, colorType, timeToNextColorNote, moveVec);
+}
+
 static BeatmapLevelsModel* beatmapLevelsModel = nullptr;
 // Finds the BeatmapLevelsModel, if it hasn't been found already
 BeatmapLevelsModel* getBeatmapLevelsModel() {
@@ -190,31 +335,34 @@ BeatmapLevelsModel* getBeatmapLevelsModel() {
     return beatmapLevelsModel;
 }
 
+// Called whenever the loaded level packs change, for instance after custom songs are loaded
+MAKE_HOOK_OFFSETLESS(BeatmapLevelsModel_UpdateAllLoadedBeatmapLevelPacks, void, BeatmapLevelsModel* self)   {
+    BeatmapLevelsModel_UpdateAllLoadedBeatmapLevelPacks(self);
+
+    // Find which packs each level is in, then forget the decisions made with the old packs
+    updateLevelPacks(self);
+    clearDecisions();
+
+    // Index any new levels in the background, so that selecting them later doesn't need to load them
+    updateNpsIndex(self);
+}
+
 // Called whenever the user selects a difficulty of a level. Used to decide whether or not to override the debris setting
 MAKE_HOOK_OFFSETLESS(RefreshContent, void, StandardLevelDetailView* self)    {
     RefreshContent(self);
 
-    getLogger().info("StandardLevelDetailView_RefreshContent");
+    PROFILE_SCOPE(REFRESH_CONTENT);
+    ASYNC_LOG_DEBUG("StandardLevelDetailView_RefreshContent");
     
     // Find the selected difficulty
     IDifficultyBeatmap* difficulty = self->selectedDifficultyBeatmap;
     IBeatmapLevel* level = difficulty->get_level();
 
-    overrideIfNecessary(level, difficulty);
-}
-
-void createDefaultConfig()  {
-    ConfigDocument& config = getConfig().config;
-    // Find if the config has been created
-    if(config.HasMember("mode")) {return;}
-
-    // Add all the default options
-    auto& alloc = config.GetAllocator();
-    config.AddMember("mode", "disable", alloc);
-    config.AddMember("notesPerSecondThreshold", 5.0, alloc);
-    config.AddMember("playlists", rapidjson::Value(rapidjson::kArrayType), alloc);
-
-    getConfig().Write(); // Write the config back to disk
+    // The decision is made in the background, so that scrolling through difficulties doesn't wait for it
+    DecisionKey key = makeDecisionKey(level, difficulty);
+    updateLevelOverrideButton(self, key.levelId);
+    traceSelect(key);
+    requestDecision(std::move(key));
 }
 
 extern "C" void setup(ModInfo& info) {
@@ -222,12 +370,12 @@ extern "C" void setup(ModInfo& info) {
     info.version = VERSION;
     modInfo = info;
 	
-    getConfig().Load(); // Load the config file
-    createDefaultConfig(); // Create the default config file if it doesn't already exist
-
-    // Find the mode that we're using
-    std::string modeString =  getConfig().config["mode"].GetString();
-    overrideMode = modeString == "enable" ? ENABLE : DISABLE;
+    startLogWriter(); // Messages from the hooks are written to the log in the background
+    loadConfig(); // Load the config file, creating the default config if it doesn't already exist
+    startConfigWriter(); // Changes are written back to disk in the background
+    loadNpsIndex(); // Load the NPS of the levels indexed in previous sessions
+    loadPerformanceProfile(); // Load the frame times measured in previous sessions
+    startTraceRecording(); // Record the hook events if it is enabled in the config
 
     getLogger().info("Completed setup!");
 }
@@ -236,6 +384,7 @@ extern "C" void load() {
     getLogger().info("Installing hooks...");
     il2cpp_functions::Init();
     QuestUI::Init();
+    findSettingsFields();
 
     // Register our custom ViewController type
     custom_types::Register::RegisterType<AutoDebrisViewController>();
@@ -247,6 +396,11 @@ extern "C" void load() {
     INSTALL_HOOK_OFFSETLESS(getLogger(), RefreshContent, il2cpp_utils::FindMethodUnsafe("", "StandardLevelDetailView", "RefreshContent", 0));
     INSTALL_HOOK_OFFSETLESS(getLogger(), MenuTransitionsHelper_StartStandardLevel, il2cpp_utils::FindMethodUnsafe("", "MenuTransitionsHelper", "StartStandardLevel", 13));
     INSTALL_HOOK_OFFSETLESS(getLogger(), MenuTransitionsHelper_StartMultiplayerLevel, il2cpp_utils::FindMethodUnsafe("", "MenuTransitionsHelper", "StartMultiplayerLevel", 15));
+    INSTALL_HOOK_OFFSETLESS(getLogger(), AudioTimeSyncController_Start, il2cpp_utils::FindMethodUnsafe("", "AudioTimeSyncController", "Start", 0));
+    INSTALL_HOOK_OFFSETLESS(getLogger(), AudioTimeSyncController_Update, il2cpp_utils::FindMethodUnsafe("", "AudioTimeSyncController", "Update", 0));
+    INSTALL_HOOK_OFFSETLESS(getLogger(), MenuTransitionsHelper_HandleMainGameSceneDidFinish, il2cpp_utils::FindMethodUnsafe("", "MenuTransitionsHelper", "HandleMainGameSceneDidFinish", 2));
+    INSTALL_HOOK_OFFSETLESS(getLogger(), NoteDebrisSpawner_SpawnDebris, il2cpp_utils::FindMethodUnsafe("", "NoteDebrisSpawner", "SpawnDebris", 9));
+    INSTALL_HOOK_OFFSETLESS(getLogger(), BeatmapLevelsModel_UpdateAllLoadedBeatmapLevelPacks, il2cpp_utils::FindMethodUnsafe("", "BeatmapLevelsModel", "UpdateAllLoadedBeatmapLevelPacks", 0));
 
     getLogger().info("Installed all hooks!");
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "DebrisSchedule.hpp"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+static const DebrisScheduleSettings SETTINGS {2.0f, 5.0f, 4.0f, 1.0f, 2.0f};
+
+// A note every second from 0 to the end, with 10 notes per second in each of the dense sections
+static std::vector<float> makeNotes(float end, const std::vector<std::pair<float, float>>& denseSections)  {
+    std::vector<float> noteTimes;
+    for(int tenth = 0; tenth <= (int) (end * 10); tenth++)  {
+        float time = tenth / 10.0f;
+        bool dense = false;
+        for(auto [start, stop] : denseSections)  {
+            dense |= time >= start && time < stop;
+        }
+        if(dense || tenth % 10 == 0)    {
+            noteTimes.push_back(time);
+        }
+    }
+    return noteTimes;
+}
+
+TEST(DebrisSchedule, SparseSongIsNeverReduced)  {
+    DebrisSchedule schedule = DebrisSchedule::build(makeNotes(60.0f, {}), SETTINGS);
+    EXPECT_TRUE(schedule.empty());
+}
+
+TEST(DebrisSchedule, DenseSectionIsReducedWithLeadTime)  {
+    DebrisSchedule schedule = DebrisSchedule::build(makeNotes(30.0f, {{10.0f, 15.0f}}), SETTINGS);
+    ASSERT_EQ(schedule.getIntervals().size(), 1u);
+    const DebrisInterval& interval = schedule.getIntervals()[0];
+    // The window becomes dense a little before the section starts, then the lead time moves it earlier still
+    EXPECT_GE(interval.start, 7.5f);
+    EXPECT_LE(interval.start, 9.0f);
+    EXPECT_GE(interval.end, 15.0f);
+    EXPECT_LE(interval.end, 17.0f);
+}
+
+TEST(DebrisSchedule, CloseSectionsAreJoined)    {
+    DebrisSchedule schedule = DebrisSchedule::build(makeNotes(60.0f, {{10.0f, 15.0f}, {16.0f, 20.0f}, {40.0f, 45.0f}}), SETTINGS);
+    const std::vector<DebrisInterval>& intervals = schedule.getIntervals();
+    ASSERT_EQ(intervals.size(), 2u);
+    EXPECT_LT(intervals[0].start, 10.0f);
+    EXPECT_GE(intervals[0].end, 20.0f);
+    EXPECT_LT(intervals[1].start, 40.0f);
+    EXPECT_GE(intervals[1].end, 45.0f);
+    EXPECT_LT(intervals[0].end, intervals[1].start);
+}
+
+TEST(DebrisSchedule, DenseEndCoversTheLastNote)  {
+    std::vector<float> noteTimes = makeNotes(20.0f, {{15.0f, 20.1f}});
+    DebrisSchedule schedule = DebrisSchedule::build(noteTimes, SETTINGS);
+    ASSERT_EQ(schedule.getIntervals().size(), 1u);
+    EXPECT_GE(schedule.getIntervals()[0].end, noteTimes.back());
+    EXPECT_LE(schedule.getIntervals()[0].end, noteTimes.back() + SETTINGS.windowSeconds);
+}
+
+TEST(DebrisSchedule, MalformedNoteTimeIsLeftOut)  {
+    std::vector<float> noteTimes = makeNotes(20.0f, {{15.0f, 20.1f}});
+    noteTimes.push_back(1e30f);
+    DebrisSchedule schedule = DebrisSchedule::build(noteTimes, SETTINGS);
+    ASSERT_EQ(schedule.getIntervals().size(), 1u);
+    EXPECT_LE(schedule.getIntervals()[0].end, DebrisSchedule::MAX_LENGTH_SECONDS + SETTINGS.windowSeconds);
+
+    noteTimes.back() = std::numeric_limits<float>::infinity();
+    schedule = DebrisSchedule::build(noteTimes, SETTINGS);
+    ASSERT_EQ(schedule.getIntervals().size(), 1u);
+    EXPECT_LE(schedule.getIntervals()[0].end, DebrisSchedule::MAX_LENGTH_SECONDS + SETTINGS.windowSeconds);
+}
+
+TEST(DebrisScheduleCursor, FollowsTheSchedule)  {
+    DebrisSchedule schedule = DebrisSchedule::build(makeNotes(60.0f, {{10.0f, 15.0f}, {40.0f, 45.0f}}), SETTINGS);
+    ASSERT_EQ(schedule.getIntervals().size(), 2u);
+
+    DebrisScheduleCursor cursor(schedule);
+    EXPECT_FALSE(cursor.isReduced(0.0f));
+    EXPECT_TRUE(cursor.isReduced(12.0f));
+    EXPECT_FALSE(cursor.isReduced(30.0f));
+    EXPECT_TRUE(cursor.isReduced(42.0f));
+    EXPECT_FALSE(cursor.isReduced(59.0f));
+    // Seeking backwards, e.g. in practice mode, starts from the beginning again
+    EXPECT_TRUE(cursor.isReduced(13.0f));
+}
+
+TEST(DebrisScheduleCursor, EmptyCursorIsNeverReduced)   {
+    DebrisScheduleCursor cursor;
+    EXPECT_FALSE(cursor.isReduced(0.0f));
+    EXPECT_FALSE(cursor.isReduced(100.0f));
+}
@@ -0,0 +1,321 @@
+#include "DecisionEngine.hpp"
+#include "FakeInputSource.hpp"
+
+#include <gtest/gtest.h>
+
+static const DecisionKey KEY {"custom_level_ABCDEF", "Standard", 4};
+
+static ConfigSnapshot makeConfig()  {
+    ConfigSnapshot config;
+    config.mode = Mode::ENABLE;
+    config.notesPerSecondThreshold = 5.0f;
+    return config;
+}
+
+static std::shared_ptr<const RuleSet> compileRules(const std::vector<RuleDefinition>& definitions)   {
+    std::vector<std::string> errors;
+    auto rules = std::make_shared<const RuleSet>(RuleSet::compile(definitions, errors));
+    EXPECT_TRUE(errors.empty());
+    return rules;
+}
+
+static Decision decideOnce(const ConfigSnapshot& config, FakeInputSource& inputs)   {
+    DecisionEngine engine(16);
+    std::optional<Decision> decision = engine.decide(config, KEY, inputs);
+    EXPECT_TRUE(decision.has_value());
+    return decision.value_or(Decision {false, OverrideReason::NONE});
+}
+
+TEST(ConfigSnapshot, OnlyDecisionInputsChangeDecisions)    {
+    ConfigSnapshot config = makeConfig();
+    ConfigSnapshot edited = config;
+    edited.logLevel = LogSeverity::ERROR;
+    edited.profiling = true;
+    edited.traceRecording = true;
+    edited.dynamicDebris = true;
+    edited.dynamicDebrisLeadTime = 2.0f;
+    edited.frameTimeBudget = 11.1f;
+    edited.overrideFields.set(OverrideField::SABER_TRAIL_INTENSITY, 0.0f);
+    EXPECT_TRUE(config.hasSameDecisionInputs(edited));
+
+    edited.notesPerSecondThreshold = 6.0f;
+    EXPECT_FALSE(config.hasSameDecisionInputs(edited));
+    edited = config;
+    edited.densityPercentile = 0.5f;
+    EXPECT_FALSE(config.hasSameDecisionInputs(edited));
+    // Editing the playlists replaces the shared set
+    edited = config;
+    edited.playlists = std::make_shared<const PlaylistIndex>();
+    EXPECT_FALSE(config.hasSameDecisionInputs(edited));
+}
+
+TEST(DecisionEngine, LevelOverrideComesBeforeEverything)  {
+    ConfigSnapshot config = makeConfig();
+    auto levelOverrides = std::make_shared<LevelOverrideList>();
+    levelOverrides->set(KEY.levelId, LevelOverride::NEVER);
+    config.levelOverrides = levelOverrides;
+    config.rules = compileRules({{"Always", true, {{"difficulty", ">=", "", 0.0f, true}}}});
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 20.0f;
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_FALSE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::LEVEL);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 0);
+}
+
+TEST(DecisionEngine, RuleComesBeforeThreshold)  {
+    ConfigSnapshot config = makeConfig();
+    config.rules = compileRules({
+        {"Not easy", true, {{"difficulty", "<", "", 0.0f, true}}},
+        {"Fast", false, {{"nps", ">", "", 8.0f, true}}}
+    });
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 10.0f;
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_FALSE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::RULE);
+    EXPECT_EQ(decision.rule, 1);
+}
+
+TEST(DecisionEngine, RulesOnlyAskForTheirInputs) {
+    ConfigSnapshot config = makeConfig();
+    config.notesPerSecondThreshold = 0.0f;
+    config.rules = compileRules({{"Long", true, {{"duration", ">", "", 300.0f, true}}}});
+
+    FakeInputSource inputs;
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_FALSE(decision.willOverride);
+    EXPECT_EQ(inputs.durationCalls, 1);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 0);
+    EXPECT_EQ(inputs.peakNotesPerSecondCalls, 0);
+
+    inputs.duration = 400.0f;
+    decision = decideOnce(config, inputs);
+    EXPECT_TRUE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::RULE);
+}
+
+TEST(DecisionEngine, MeasuredPerformanceReplacesThreshold)  {
+    ConfigSnapshot config = makeConfig();
+    config.adaptiveMode = true;
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 2.0f;
+    inputs.performance = MeasuredPerformance::OVER_BUDGET;
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_TRUE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::FRAME_TIME);
+
+    // A difficulty that stayed within budget isn't overridden, however dense it is
+    FakeInputSource withinBudget;
+    withinBudget.notesPerSecond = 20.0f;
+    withinBudget.performance = MeasuredPerformance::WITHIN_BUDGET;
+    decision = decideOnce(config, withinBudget);
+    EXPECT_FALSE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::NONE);
+    EXPECT_EQ(withinBudget.notesPerSecondCalls, 0);
+}
+
+TEST(DecisionEngine, PackRulesMatchAnyPack)  {
+    ConfigSnapshot config = makeConfig();
+    config.notesPerSecondThreshold = 0.0f;
+    config.rules = compileRules({{"Ranked", true, {{"pack", "==", "Ranked", 0.0f, false}}}});
+
+    FakeInputSource inputs;
+    inputs.packs = std::vector<LevelPack> {{"other_id", "Other"}, {"ranked_id", "Ranked"}};
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_TRUE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::RULE);
+
+    inputs.packs = std::vector<LevelPack> {{"other_id", "Other"}};
+    EXPECT_FALSE(decideOnce(config, inputs).willOverride);
+}
+
+TEST(DecisionEngine, ThresholdComesBeforePlaylists)  {
+    ConfigSnapshot config = makeConfig();
+    auto playlists = std::make_shared<PlaylistIndex>();
+    playlists->insert("pack_id", "Pack");
+    config.playlists = playlists;
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 10.0f;
+    inputs.packs = std::vector<LevelPack> {{"pack_id", "Pack"}};
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_TRUE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::NPS_THRESHOLD);
+    EXPECT_EQ(inputs.packCalls, 0);
+}
+
+TEST(DecisionEngine, DisableModeOverridesBelowThreshold)  {
+    ConfigSnapshot config = makeConfig();
+    config.mode = Mode::DISABLE;
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 3.0f;
+    EXPECT_TRUE(decideOnce(config, inputs).willOverride);
+
+    inputs.notesPerSecond = 7.0f;
+    EXPECT_FALSE(decideOnce(config, inputs).willOverride);
+}
+
+TEST(DecisionEngine, ZeroThresholdSkipsNotesPerSecond)   {
+    ConfigSnapshot config = makeConfig();
+    config.notesPerSecondThreshold = 0.0f;
+
+    FakeInputSource inputs;
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_FALSE(decision.willOverride);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 0);
+}
+
+TEST(DecisionEngine, PeakDensityFallsBackToAverage)  {
+    ConfigSnapshot config = makeConfig();
+    config.densityMode = DensityMode::PEAK;
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 3.0f;
+    inputs.peakNotesPerSecond = 8.0f;
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_TRUE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::PEAK_DENSITY);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 0);
+
+    // The peak isn't known until the level is indexed
+    FakeInputSource unindexed;
+    unindexed.notesPerSecond = 6.0f;
+    decision = decideOnce(config, unindexed);
+    EXPECT_TRUE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::NPS_THRESHOLD);
+}
+
+TEST(DecisionEngine, DensitySettingsClearCachedPeaks)   {
+    ConfigSnapshot config = makeConfig();
+    config.densityMode = DensityMode::PEAK;
+    DecisionEngine engine(16);
+
+    FakeInputSource inputs;
+    inputs.peakNotesPerSecond = 8.0f;
+    engine.decide(config, KEY, inputs);
+    config.generation++;
+    engine.decide(config, KEY, inputs);
+    EXPECT_EQ(inputs.peakNotesPerSecondCalls, 1);
+
+    // The peak depends on the window, so it has to be found again
+    config.generation++;
+    config.densityWindow = 4.0f;
+    engine.decide(config, KEY, inputs);
+    EXPECT_EQ(inputs.peakNotesPerSecondCalls, 2);
+}
+
+TEST(DecisionEngine, PlaylistsComeLast)  {
+    ConfigSnapshot config = makeConfig();
+    auto playlists = std::make_shared<PlaylistIndex>();
+    playlists->insert("", "Pack");
+    config.playlists = playlists;
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 2.0f;
+    inputs.packs = std::vector<LevelPack> {{"other_id", "Other"}, {"pack_id", "Pack"}};
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_TRUE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::PLAYLIST);
+
+    inputs.packs = std::vector<LevelPack> {{"other_id", "Other"}};
+    decision = decideOnce(config, inputs);
+    EXPECT_FALSE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::NONE);
+}
+
+TEST(DecisionEngine, PlaylistPatternsMatchIdOrName)  {
+    ConfigSnapshot config = makeConfig();
+    std::vector<std::string> errors;
+    config.playlistPatterns = std::make_shared<const PackMatcher>(PackMatcher::compile({"ranked_*"}, errors));
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 2.0f;
+    inputs.packs = std::vector<LevelPack> {{"other_id", "Other"}, {"ranked_pack", "Ranked"}};
+    Decision decision = decideOnce(config, inputs);
+    EXPECT_TRUE(decision.willOverride);
+    EXPECT_EQ(decision.reason, OverrideReason::PLAYLIST);
+
+    inputs.packs = std::vector<LevelPack> {{"", "ranked_by_name"}};
+    EXPECT_TRUE(decideOnce(config, inputs).willOverride);
+
+    inputs.packs = std::vector<LevelPack> {{"other_id", "Other"}};
+    EXPECT_FALSE(decideOnce(config, inputs).willOverride);
+}
+
+TEST(DecisionEngine, LevelWithoutPackDoesntMatchPatterns)   {
+    ConfigSnapshot config = makeConfig();
+    std::vector<std::string> errors;
+    config.playlistPatterns = std::make_shared<const PackMatcher>(PackMatcher::compile({"*"}, errors));
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 2.0f;
+    EXPECT_FALSE(decideOnce(config, inputs).willOverride);
+    inputs.packs = std::vector<LevelPack> {{"", ""}};
+    EXPECT_FALSE(decideOnce(config, inputs).willOverride);
+}
+
+TEST(DecisionEngine, MissingInputIsRetried)  {
+    ConfigSnapshot config = makeConfig();
+    auto playlists = std::make_shared<PlaylistIndex>();
+    playlists->insert("pack_id", "Pack");
+    config.playlists = playlists;
+    DecisionEngine engine(16);
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = std::nullopt;
+    EXPECT_FALSE(engine.decide(config, KEY, inputs).has_value());
+
+    // The NPS is found, but the pack can't be looked up yet
+    inputs.notesPerSecond = 2.0f;
+    inputs.packs = std::nullopt;
+    EXPECT_FALSE(engine.decide(config, KEY, inputs).has_value());
+
+    inputs.packs = std::vector<LevelPack> {{"pack_id", "Pack"}};
+    std::optional<Decision> decision = engine.decide(config, KEY, inputs);
+    ASSERT_TRUE(decision.has_value());
+    EXPECT_TRUE(decision->willOverride);
+    EXPECT_EQ(decision->reason, OverrideReason::PLAYLIST);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 2);
+}
+
+TEST(DecisionEngine, CachedInputsAreReusedAcrossGenerations)  {
+    ConfigSnapshot config = makeConfig();
+    DecisionEngine engine(16);
+
+    FakeInputSource inputs;
+    inputs.notesPerSecond = 6.0f;
+    EXPECT_TRUE(engine.decide(config, KEY, inputs)->willOverride);
+    EXPECT_TRUE(engine.decide(config, KEY, inputs)->willOverride);
+
+    // A new config redoes the decision, but the NPS of the difficulty doesn't change
+    config.generation++;
+    config.notesPerSecondThreshold = 7.0f;
+    EXPECT_FALSE(engine.decide(config, KEY, inputs)->willOverride);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 1);
+}
+
+TEST(DecisionEngine, LeastRecentlyUsedDecisionIsEvicted)    {
+    ConfigSnapshot config = makeConfig();
+    DecisionEngine engine(2);
+    DecisionKey first {"level_1", "Standard", 4};
+    DecisionKey second {"level_2", "Standard", 4};
+    DecisionKey third {"level_3", "Standard", 4};
+
+    FakeInputSource inputs;
+    engine.decide(config, first, inputs);
+    engine.decide(config, second, inputs);
+    engine.decide(config, first, inputs);
+    engine.decide(config, third, inputs);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 3);
+
+    // The second level was used least recently, so it was evicted to make room for the third
+    engine.decide(config, first, inputs);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 3);
+    engine.decide(config, second, inputs);
+    EXPECT_EQ(inputs.notesPerSecondCalls, 4);
+}
@@ -0,0 +1,81 @@
+#include "DensityAnalyzer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// A note every half second for 10 seconds, with a burst of 10 more notes between 5 and 6 seconds
+static std::vector<float> makeBurstNotes()  {
+    std::vector<float> noteTimes;
+    for(int i = 0; i < 20; i++) {
+        noteTimes.push_back(i * 0.5f);
+    }
+    for(int i = 0; i < 10; i++) {
+        noteTimes.push_back(5.05f + i * 0.1f);
+    }
+    std::sort(noteTimes.begin(), noteTimes.end());
+    return noteTimes;
+}
+
+TEST(DensityAnalyzer, FindsPeakWindow)  {
+    DensityAnalyzer analyzer(2.0f, 1.0f);
+    DensityResult result = analyzer.analyze(makeBurstNotes(), 10.0f);
+    // The densest window has the whole burst and 4 of the regular notes
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 7.0f);
+    EXPECT_FLOAT_EQ(result.percentileNotesPerSecond, 7.0f);
+}
+
+TEST(DensityAnalyzer, PercentileIgnoresShortBursts)    {
+    DensityAnalyzer analyzer(2.0f, 0.5f);
+    DensityResult result = analyzer.analyze(makeBurstNotes(), 10.0f);
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 7.0f);
+    EXPECT_FLOAT_EQ(result.percentileNotesPerSecond, 2.0f);
+}
+
+TEST(DensityAnalyzer, ShortSongIsOneWindow)  {
+    DensityAnalyzer analyzer(2.0f, 0.9f);
+    DensityResult result = analyzer.analyze({0.1f, 0.2f, 0.3f}, 1.0f);
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 1.5f);
+    EXPECT_FLOAT_EQ(result.percentileNotesPerSecond, 1.5f);
+}
+
+TEST(DensityAnalyzer, NotesAfterTheSongAreCounted)   {
+    DensityAnalyzer analyzer(2.0f, 1.0f);
+    DensityResult result = analyzer.analyze({11.0f, 11.5f, 12.0f, 12.5f}, 5.0f);
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 2.0f);
+}
+
+TEST(DensityAnalyzer, MalformedTimesDontGrowTheBins)  {
+    DensityAnalyzer analyzer(2.0f, 1.0f);
+    // A note far past the end of the audio isn't counted, rather than needing a bin for every 0.25 seconds up to it
+    DensityResult result = analyzer.analyze({1.0f, 1.5f, 2.0f, 1e30f}, 10.0f);
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 1.5f);
+    result = analyzer.analyze({1.0f, 1.5f, 2.0f, std::numeric_limits<float>::infinity()}, 10.0f);
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 1.5f);
+
+    // A malformed duration is capped as well
+    result = analyzer.analyze({1.0f, 1.5f, 2.0f}, 1e30f);
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 1.5f);
+    result = analyzer.analyze({1.0f, 1.5f, 2.0f}, std::nanf(""));
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 0.0f);
+}
+
+TEST(DensityAnalyzer, EmptyDifficultyHasNoDensity)  {
+    DensityAnalyzer analyzer(2.0f, 0.9f);
+    DensityResult result = analyzer.analyze({}, 60.0f);
+    EXPECT_EQ(result.peakNotesPerSecond, 0.0f);
+    EXPECT_EQ(result.percentileNotesPerSecond, 0.0f);
+}
+
+TEST(DensityAnalyzer, ReuseGivesSameResult) {
+    DensityAnalyzer analyzer(2.0f, 1.0f);
+    std::vector<float> longSong;
+    for(int i = 0; i < 1000; i++)   {
+        longSong.push_back(i * 0.2f);
+    }
+    analyzer.analyze(longSong, 200.0f);
+    DensityResult result = analyzer.analyze(makeBurstNotes(), 10.0f);
+    EXPECT_FLOAT_EQ(result.peakNotesPerSecond, 7.0f);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "DecisionEngine.hpp"
+
+#include <optional>
+#include <vector>
+
+// Input source with fixed inputs, which counts how many times the engine asks for each one
+class FakeInputSource : public DecisionInputSource {
+public:
+    std::optional<float> notesPerSecond = 4.0f;
+    float peakNotesPerSecond = -1.0f;
+    std::optional<float> duration = 120.0f;
+    std::optional<std::vector<LevelPack>> packs = std::vector<LevelPack>(); // Empty to act like a source that can't look up packs yet
+    MeasuredPerformance performance = MeasuredPerformance::UNKNOWN;
+
+    int notesPerSecondCalls = 0;
+    int peakNotesPerSecondCalls = 0;
+    int durationCalls = 0;
+    int packCalls = 0;
+    int performanceCalls = 0;
+
+    std::optional<float> calculateNotesPerSecond() override    {
+        notesPerSecondCalls++;
+        return notesPerSecond;
+    }
+
+    float calculatePeakNotesPerSecond() override    {
+        peakNotesPerSecondCalls++;
+        return peakNotesPerSecond;
+    }
+
+    std::optional<float> calculateDuration() override  {
+        durationCalls++;
+        return duration;
+    }
+
+    bool findLevelPacks(std::vector<LevelPack>& found) override {
+        packCalls++;
+        if(!packs)  {return false;}
+        found.insert(found.end(), packs->begin(), packs->end());
+        return true;
+    }
+
+    MeasuredPerformance findMeasuredPerformance() override  {
+        performanceCalls++;
+        return performance;
+    }
+};
@@ -0,0 +1,111 @@
+#include "LevelOverrideList.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+
+static std::string listPath(const char* name)   {
+    return ::testing::TempDir() + name;
+}
+
+static void writeFile(const std::string& path, const std::vector<uint8_t>& data)    {
+    FILE* file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+}
+
+static std::vector<uint8_t> readFile(const std::string& path)   {
+    std::vector<uint8_t> data;
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file)   {return data;}
+    uint8_t byte;
+    while(fread(&byte, 1, 1, file) == 1)  {data.push_back(byte);}
+    fclose(file);
+    return data;
+}
+
+TEST(LevelOverrideList, SetAndFind) {
+    LevelOverrideList list;
+    list.set("level_b", LevelOverride::NEVER);
+    list.set("level_a", LevelOverride::ALWAYS);
+    list.set("level_c", LevelOverride::ALWAYS);
+    EXPECT_EQ(list.size(), 3u);
+    EXPECT_EQ(list.find("level_a"), LevelOverride::ALWAYS);
+    EXPECT_EQ(list.find("level_b"), LevelOverride::NEVER);
+    EXPECT_EQ(list.find("level_d"), LevelOverride::NONE);
+    EXPECT_TRUE(std::is_sorted(list.getHashes().begin(), list.getHashes().end()));
+
+    list.set("level_c", LevelOverride::NEVER);
+    EXPECT_EQ(list.find("level_c"), LevelOverride::NEVER);
+    // Setting a level back to none removes it
+    list.set("level_b", LevelOverride::NONE);
+    EXPECT_EQ(list.size(), 2u);
+    EXPECT_EQ(list.find("level_b"), LevelOverride::NONE);
+}
+
+TEST(LevelOverrideList, RoundTripsThroughFile)  {
+    std::string path = listPath("round-trip.bin");
+    LevelOverrideList list;
+    for(int i = 0; i < 1000; i++)   {
+        list.set("custom_level_" + std::to_string(i), i % 3 == 0 ? LevelOverride::NEVER : LevelOverride::ALWAYS);
+    }
+    ASSERT_TRUE(list.write(path));
+
+    LevelOverrideList read = LevelOverrideList::read(path);
+    EXPECT_EQ(read.getHashes(), list.getHashes());
+    EXPECT_EQ(read.getStates(), list.getStates());
+    EXPECT_EQ(read.find("custom_level_3"), LevelOverride::NEVER);
+    EXPECT_EQ(read.find("custom_level_4"), LevelOverride::ALWAYS);
+    remove(path.c_str());
+}
+
+TEST(LevelOverrideList, MissingFileIsEmpty) {
+    EXPECT_TRUE(LevelOverrideList::read(listPath("missing.bin")).empty());
+}
+
+TEST(LevelOverrideList, CorruptCountIsRejected)  {
+    std::string path = listPath("corrupt-count.bin");
+    LevelOverrideList list;
+    list.set("level_a", LevelOverride::ALWAYS);
+    ASSERT_TRUE(list.write(path));
+
+    // The count follows the magic and version
+    std::vector<uint8_t> data = readFile(path);
+    ASSERT_GE(data.size(), 12u);
+    data[8] = data[9] = data[10] = data[11] = 0xFF;
+    writeFile(path, data);
+    EXPECT_TRUE(LevelOverrideList::read(path).empty());
+    remove(path.c_str());
+}
+
+TEST(LevelOverrideList, TruncatedFileIsRejected)  {
+    std::string path = listPath("truncated.bin");
+    LevelOverrideList list;
+    list.set("level_a", LevelOverride::ALWAYS);
+    list.set("level_b", LevelOverride::NEVER);
+    ASSERT_TRUE(list.write(path));
+
+    std::vector<uint8_t> data = readFile(path);
+    data.pop_back();
+    writeFile(path, data);
+    EXPECT_TRUE(LevelOverrideList::read(path).empty());
+    remove(path.c_str());
+}
+
+TEST(LevelOverrideList, UnsortedFileIsRejected)  {
+    std::string path = listPath("unsorted.bin");
+    LevelOverrideList list;
+    list.set("level_a", LevelOverride::ALWAYS);
+    list.set("level_b", LevelOverride::NEVER);
+    ASSERT_TRUE(list.write(path));
+
+    // Swap the two hashes, which come straight after the 16 byte header
+    std::vector<uint8_t> data = readFile(path);
+    ASSERT_GE(data.size(), 32u);
+    std::swap_ranges(data.begin() + 16, data.begin() + 24, data.begin() + 24);
+    writeFile(path, data);
+    EXPECT_TRUE(LevelOverrideList::read(path).empty());
+    remove(path.c_str());
+}
@@ -0,0 +1,60 @@
+#include "LevelPackIndex.hpp"
+
+#include <gtest/gtest.h>
+
+static std::vector<std::string> findPackIds(const LevelPackIndex& index, std::string_view levelId)    {
+    std::vector<std::string> packIds;
+    index.forEachPack(levelId, [&](const LevelPack& pack) {packIds.push_back(pack.id);});
+    return packIds;
+}
+
+TEST(LevelPackIndex, FindsEveryPackOfALevel)    {
+    LevelPackIndex index;
+    uint32_t first = index.addPack("pack_a", "Pack A");
+    uint32_t second = index.addPack("pack_b", "Pack B");
+    index.addLevel(first, "custom_level_1");
+    index.addLevel(first, "custom_level_2");
+    index.addLevel(second, "custom_level_1");
+    index.finish();
+
+    EXPECT_EQ(findPackIds(index, "custom_level_1"), (std::vector<std::string> {"pack_a", "pack_b"}));
+    EXPECT_EQ(findPackIds(index, "custom_level_2"), (std::vector<std::string> {"pack_a"}));
+    EXPECT_TRUE(findPackIds(index, "custom_level_3").empty());
+    // The ID must match exactly, not just start the same
+    EXPECT_TRUE(findPackIds(index, "custom_level_").empty());
+}
+
+TEST(LevelPackIndex, DuplicateLevelsAreListedOnce)  {
+    LevelPackIndex index;
+    uint32_t pack = index.addPack("pack_a", "Pack A");
+    index.addLevel(pack, "custom_level_1");
+    index.addLevel(pack, "custom_level_1");
+    index.finish();
+
+    EXPECT_EQ(index.getLevelCount(), 1u);
+    EXPECT_EQ(findPackIds(index, "custom_level_1"), (std::vector<std::string> {"pack_a"}));
+}
+
+TEST(LevelPackIndex, ManyLevelsInManyPacks)    {
+    LevelPackIndex index;
+    std::vector<uint32_t> packs;
+    for(int i = 0; i < 10; i++) {
+        packs.push_back(index.addPack("pack_" + std::to_string(i), "Pack " + std::to_string(i)));
+    }
+    // Level i is in packs i % 10 and (i + 3) % 10, added in an order that isn't sorted
+    for(int i = 999; i >= 0; i--)   {
+        index.addLevel(packs[i % 10], "custom_level_" + std::to_string(i));
+        index.addLevel(packs[(i + 3) % 10], "custom_level_" + std::to_string(i));
+    }
+    index.finish();
+
+    EXPECT_EQ(index.getLevelCount(), 2000u);
+    for(int i = 0; i < 1000; i++)   {
+        std::vector<std::string> packIds = findPackIds(index, "custom_level_" + std::to_string(i));
+        ASSERT_EQ(packIds.size(), 2u);
+        std::sort(packIds.begin(), packIds.end());
+        std::vector<std::string> expected {"pack_" + std::to_string(i % 10), "pack_" + std::to_string((i + 3) % 10)};
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(packIds, expected);
+    }
+}
@@ -0,0 +1,150 @@
+#include "LogRing.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+template<size_t Capacity, size_t MessageLength>
+static bool pushFormatted(LogRing<Capacity, MessageLength>& ring, LogSeverity level, const char* format, ...)  {
+    va_list args;
+    va_start(args, format);
+    bool pushed = ring.push(level, format, args);
+    va_end(args);
+    return pushed;
+}
+
+template<size_t Capacity, size_t MessageLength>
+static std::optional<std::string> popText(LogRing<Capacity, MessageLength>& ring)   {
+    std::optional<std::string> text;
+    ring.pop([&](LogSeverity, const char* message) {text = message;});
+    return text;
+}
+
+TEST(LogRing, EmptyRingHasNothingToPop) {
+    LogRing<4, 32> ring;
+    EXPECT_EQ(popText(ring), std::nullopt);
+    EXPECT_EQ(ring.takeDropped(), 0u);
+}
+
+TEST(LogRing, KeepsOrderAndLevelAcrossWraparound) {
+    LogRing<4, 32> ring;
+    int next = 0;
+    // Three messages at a time in a ring of four moves the start around every slot
+    for(int round = 0; round < 10; round++) {
+        for(int i = 0; i < 3; i++)  {
+            ASSERT_TRUE(pushFormatted(ring, (LogSeverity) (i % 4), "message %d", round * 3 + i));
+        }
+        for(int i = 0; i < 3; i++)  {
+            bool popped = ring.pop([&](LogSeverity level, const char* text) {
+                EXPECT_EQ(level, (LogSeverity) (i % 4));
+                EXPECT_EQ(std::string(text), "message " + std::to_string(next));
+            });
+            ASSERT_TRUE(popped);
+            next++;
+        }
+        EXPECT_EQ(popText(ring), std::nullopt);
+    }
+}
+
+TEST(LogRing, DropsAndCountsMessagesWhenFull)   {
+    LogRing<4, 32> ring;
+    for(int i = 0; i < 4; i++)  {
+        EXPECT_TRUE(pushFormatted(ring, LogSeverity::INFO, "%d", i));
+    }
+    EXPECT_FALSE(pushFormatted(ring, LogSeverity::INFO, "dropped"));
+    EXPECT_FALSE(pushFormatted(ring, LogSeverity::INFO, "dropped"));
+    EXPECT_EQ(ring.takeDropped(), 2u);
+    EXPECT_EQ(ring.takeDropped(), 0u);
+
+    // The oldest messages are kept, and popping one makes room again
+    EXPECT_EQ(popText(ring), "0");
+    EXPECT_TRUE(pushFormatted(ring, LogSeverity::INFO, "4"));
+    for(const char* expected : {"1", "2", "3", "4"})  {
+        EXPECT_EQ(popText(ring), expected);
+    }
+}
+
+TEST(LogRing, TruncatesLongMessages)    {
+    LogRing<2, 8> ring;
+    ASSERT_TRUE(pushFormatted(ring, LogSeverity::INFO, "%s", "a message that is too long"));
+    EXPECT_EQ(popText(ring), "a messa");
+}
+
+TEST(LogRing, ConcurrentProducersLoseNothingUncounted)  {
+    constexpr int PRODUCER_COUNT = 4;
+    constexpr int MESSAGES_PER_PRODUCER = 20000;
+    LogRing<64, 32> ring;
+
+    std::atomic<int> producersRunning = PRODUCER_COUNT;
+    std::vector<std::thread> producers;
+    for(int producer = 0; producer < PRODUCER_COUNT; producer++)    {
+        producers.emplace_back([&ring, &producersRunning, producer]()   {
+            for(int i = 0; i < MESSAGES_PER_PRODUCER; i++)  {
+                pushFormatted(ring, LogSeverity::INFO, "%d %d", producer, i);
+            }
+            producersRunning--;
+        });
+    }
+
+    // Messages from each producer must come out in the order it pushed them, without duplicates
+    int lastSequence[PRODUCER_COUNT];
+    std::fill(std::begin(lastSequence), std::end(lastSequence), -1);
+    uint64_t received = 0;
+    auto consume = [&](LogSeverity, const char* text)  {
+        int producer, sequence;
+        ASSERT_EQ(sscanf(text, "%d %d", &producer, &sequence), 2);
+        ASSERT_GE(producer, 0);
+        ASSERT_LT(producer, PRODUCER_COUNT);
+        EXPECT_GT(sequence, lastSequence[producer]);
+        lastSequence[producer] = sequence;
+        received++;
+    };
+    while(producersRunning > 0) {
+        ring.pop(consume);
+    }
+    while(ring.pop(consume)) {}
+    for(std::thread& producer : producers)  {
+        producer.join();
+    }
+
+    EXPECT_EQ(received + ring.takeDropped(), (uint64_t) PRODUCER_COUNT * MESSAGES_PER_PRODUCER);
+}
+
+TEST(LogRing, ConcurrentConsumersPopEachMessageOnce)    {
+    constexpr int MESSAGE_COUNT = 50000;
+    LogRing<128, 16> ring;
+
+    std::atomic<bool> producing = true;
+    std::atomic<uint64_t> received = 0;
+    std::vector<std::atomic<int>> seen(MESSAGE_COUNT);
+    auto consumer = [&]()   {
+        auto consume = [&](LogSeverity, const char* text)  {
+            seen[atoi(text)]++;
+            received++;
+        };
+        while(producing) {ring.pop(consume);}
+        while(ring.pop(consume)) {}
+    };
+    std::thread firstConsumer(consumer);
+    std::thread secondConsumer(consumer);
+
+    for(int i = 0; i < MESSAGE_COUNT; i++)  {
+        while(!pushFormatted(ring, LogSeverity::INFO, "%d", i)) {}
+    }
+    producing = false;
+    firstConsumer.join();
+    secondConsumer.join();
+
+    EXPECT_EQ(received, (uint64_t) MESSAGE_COUNT);
+    for(int i = 0; i < MESSAGE_COUNT; i++)  {
+        ASSERT_EQ(seen[i], 1) << "message " << i;
+    }
+}
@@ -0,0 +1,67 @@
+#include "PackMatcher.hpp"
+
+#include <gtest/gtest.h>
+
+static PackMatcher compile(const std::vector<std::string>& patterns)   {
+    std::vector<std::string> errors;
+    PackMatcher matcher = PackMatcher::compile(patterns, errors);
+    EXPECT_TRUE(errors.empty());
+    return matcher;
+}
+
+TEST(PackMatcher, StarMatchesAnyRun)    {
+    PackMatcher matcher = compile({"Ranked *"});
+    EXPECT_TRUE(matcher.matches("Ranked "));
+    EXPECT_TRUE(matcher.matches("Ranked 12 stars"));
+    EXPECT_FALSE(matcher.matches("Ranked"));
+    EXPECT_FALSE(matcher.matches("Unranked 12"));
+}
+
+TEST(PackMatcher, QuestionMarkMatchesOneCharacter)  {
+    PackMatcher matcher = compile({"Tier ?"});
+    EXPECT_TRUE(matcher.matches("Tier 1"));
+    EXPECT_FALSE(matcher.matches("Tier "));
+    EXPECT_FALSE(matcher.matches("Tier 10"));
+}
+
+TEST(PackMatcher, MatchesWholeNameIgnoringCase)  {
+    PackMatcher matcher = compile({"*speed*"});
+    EXPECT_TRUE(matcher.matches("Speed Tech"));
+    EXPECT_TRUE(matcher.matches("HIGH SPEED"));
+    EXPECT_FALSE(matcher.matches("Spee d"));
+}
+
+TEST(PackMatcher, BackslashEscapesWildcards)    {
+    PackMatcher matcher = compile({"What\\?"});
+    EXPECT_TRUE(matcher.matches("What?"));
+    EXPECT_FALSE(matcher.matches("Whats"));
+}
+
+TEST(PackMatcher, AnyPatternCanMatch)   {
+    PackMatcher matcher = compile({"a*", "*z", "m?m"});
+    EXPECT_TRUE(matcher.matches("apple"));
+    EXPECT_TRUE(matcher.matches("fizz"));
+    EXPECT_TRUE(matcher.matches("mom"));
+    EXPECT_FALSE(matcher.matches("mommy"));
+}
+
+TEST(PackMatcher, InvalidPatternsAreSkipped)    {
+    std::vector<std::string> errors;
+    PackMatcher matcher = PackMatcher::compile({"", "Valid*"}, errors);
+    EXPECT_EQ(errors.size(), 1u);
+    EXPECT_EQ(matcher.getPatterns(), std::vector<std::string> {"Valid*"});
+    EXPECT_TRUE(matcher.matches("Valid pack"));
+}
+
+TEST(PackMatcher, EmptyMatcherMatchesNothing)   {
+    PackMatcher matcher;
+    EXPECT_TRUE(matcher.empty());
+    EXPECT_FALSE(matcher.matches(""));
+    EXPECT_FALSE(matcher.matches("Pack"));
+}
+
+TEST(PackMatcher, DetectsWildcards) {
+    EXPECT_TRUE(PackMatcher::isPattern("Ranked *"));
+    EXPECT_TRUE(PackMatcher::isPattern("Tier ?"));
+    EXPECT_FALSE(PackMatcher::isPattern("Ranked"));
+}
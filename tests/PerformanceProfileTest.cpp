@@ -0,0 +1,73 @@
+#include "PerformanceProfile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+static std::string profilePath(const char* name)    {
+    return ::testing::TempDir() + name;
+}
+
+TEST(PerformanceProfile, RecordsPlays)  {
+    PerformanceProfile profile;
+    profile.record(30, 16.0f, 13.9f, false);
+    profile.record(10, 10.0f, 13.9f, false);
+    EXPECT_EQ(profile.size(), 2u);
+    EXPECT_EQ(profile.getPerformance(30), MeasuredPerformance::OVER_BUDGET);
+    EXPECT_EQ(profile.getPerformance(10), MeasuredPerformance::WITHIN_BUDGET);
+    EXPECT_EQ(profile.getPerformance(20), MeasuredPerformance::UNKNOWN);
+
+    // The last play replaces the earlier ones
+    profile.record(30, 12.0f, 13.9f, false);
+    EXPECT_EQ(profile.getPerformance(30), MeasuredPerformance::WITHIN_BUDGET);
+    EXPECT_EQ(profile.find(30)->frameTime, 12.0f);
+}
+
+TEST(PerformanceProfile, ReducedPlayOnlyShowsOverBudget)  {
+    PerformanceProfile profile;
+    profile.record(1, 10.0f, 13.9f, true);
+    EXPECT_EQ(profile.getPerformance(1), MeasuredPerformance::UNKNOWN);
+    profile.record(1, 15.0f, 13.9f, true);
+    EXPECT_EQ(profile.getPerformance(1), MeasuredPerformance::OVER_BUDGET);
+    // Being within budget with debris reduced says nothing about playing with debris on
+    profile.record(1, 10.0f, 13.9f, true);
+    EXPECT_EQ(profile.getPerformance(1), MeasuredPerformance::OVER_BUDGET);
+}
+
+TEST(PerformanceProfile, RoundTripsThroughFile)  {
+    std::string path = profilePath("profile.bin");
+    PerformanceProfile profile;
+    for(uint64_t key = 0; key < 1000; key++)    {
+        profile.record(key * 7919, 10.0f + key % 8, 13.9f, false);
+    }
+    ASSERT_TRUE(profile.write(path));
+
+    PerformanceProfile read = PerformanceProfile::read(path);
+    EXPECT_EQ(read.size(), profile.size());
+    EXPECT_EQ(read.getPerformance(7 * 7919), MeasuredPerformance::OVER_BUDGET);
+    EXPECT_EQ(read.getPerformance(8 * 7919), MeasuredPerformance::WITHIN_BUDGET);
+    EXPECT_EQ(read.find(7 * 7919)->frameTime, 17.0f);
+    remove(path.c_str());
+}
+
+TEST(PerformanceProfile, CorruptCountIsRejected)   {
+    std::string path = profilePath("corrupt-profile.bin");
+    PerformanceProfile profile;
+    profile.record(1, 10.0f, 13.9f, false);
+    ASSERT_TRUE(profile.write(path));
+
+    // The entry count follows the magic and version
+    FILE* file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    uint32_t entryCount = UINT32_MAX;
+    fseek(file, 8, SEEK_SET);
+    fwrite(&entryCount, sizeof(entryCount), 1, file);
+    fclose(file);
+
+    EXPECT_EQ(PerformanceProfile::read(path).size(), 0u);
+    remove(path.c_str());
+}
+
+TEST(PerformanceProfile, MissingFileIsEmpty)    {
+    EXPECT_EQ(PerformanceProfile::read(profilePath("missing-profile.bin")).size(), 0u);
+}
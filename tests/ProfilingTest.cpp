@@ -0,0 +1,93 @@
+#include "Profiling.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+TEST(LatencyHistogram, EmptyHistogramIsZero)    {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.getCount(), 0u);
+    EXPECT_EQ(histogram.getMax(), 0u);
+    EXPECT_EQ(histogram.getMean(), 0.0);
+    EXPECT_EQ(histogram.getPercentile(50), 0u);
+}
+
+TEST(LatencyHistogram, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for(uint64_t value = 0; value < 32; value++)  {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.getPercentile(25), 7u);
+    EXPECT_EQ(histogram.getPercentile(50), 15u);
+    EXPECT_EQ(histogram.getPercentile(75), 23u);
+    EXPECT_EQ(histogram.getPercentile(100), 31u);
+}
+
+TEST(LatencyHistogram, PercentileIsTheTopOfItsBucket)  {
+    LatencyHistogram histogram;
+    histogram.record(1000);
+    histogram.record(2000);
+    // 1000 is in the bucket from 992 to 1023, which is 1/16 of 512 wide
+    EXPECT_EQ(histogram.getPercentile(50), 1023u);
+    // but a percentile is never more than the largest value recorded
+    EXPECT_EQ(histogram.getPercentile(100), 2000u);
+}
+
+TEST(LatencyHistogram, BucketsAreWithinOneSixteenth)  {
+    for(uint64_t value : {16ull, 17ull, 33ull, 100ull, 4095ull, 4096ull, 12345ull, 1000000007ull, 1ull << 40})  {
+        LatencyHistogram histogram;
+        histogram.record(value);
+        histogram.record(value * 4);
+        uint64_t percentile = histogram.getPercentile(50);
+        EXPECT_GE(percentile, value);
+        EXPECT_LE(percentile, value + value / LatencyHistogram::SUB_BUCKET_COUNT);
+    }
+}
+
+TEST(LatencyHistogram, LargestValuesHaveABucket)   {
+    LatencyHistogram histogram;
+    histogram.record(UINT64_MAX);
+    EXPECT_EQ(histogram.getPercentile(100), UINT64_MAX);
+    EXPECT_EQ(histogram.getMax(), UINT64_MAX);
+}
+
+TEST(LatencyHistogram, MeanAndMax)  {
+    LatencyHistogram histogram;
+    histogram.record(10);
+    histogram.record(30);
+    histogram.record(20);
+    EXPECT_EQ(histogram.getCount(), 3u);
+    EXPECT_EQ(histogram.getMax(), 30u);
+    EXPECT_DOUBLE_EQ(histogram.getMean(), 20.0);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.getCount(), 0u);
+    EXPECT_EQ(histogram.getMax(), 0u);
+    EXPECT_EQ(histogram.getPercentile(100), 0u);
+}
+
+TEST(LatencyHistogram, ConcurrentRecordsAreAllCounted)  {
+    constexpr int THREAD_COUNT = 8;
+    constexpr int RECORDS_PER_THREAD = 100000;
+    LatencyHistogram histogram;
+
+    std::vector<std::thread> threads;
+    for(int thread = 0; thread < THREAD_COUNT; thread++)    {
+        threads.emplace_back([&histogram, thread]() {
+            for(int i = 0; i < RECORDS_PER_THREAD; i++) {
+                histogram.record((thread + 1) * 100);
+            }
+        });
+    }
+    for(std::thread& thread : threads)  {
+        thread.join();
+    }
+
+    EXPECT_EQ(histogram.getCount(), (uint64_t) THREAD_COUNT * RECORDS_PER_THREAD);
+    EXPECT_EQ(histogram.getMax(), THREAD_COUNT * 100u);
+    EXPECT_DOUBLE_EQ(histogram.getMean(), (THREAD_COUNT + 1) * 50.0);
+    // Each thread recorded an eighth of the samples, so the median is between the fourth and fifth thread's values
+    EXPECT_GE(histogram.getPercentile(50), 400u);
+    EXPECT_LE(histogram.getPercentile(50), 500u);
+}
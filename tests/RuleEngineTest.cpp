@@ -0,0 +1,107 @@
+#include "RuleEngine.hpp"
+#include "Difficulty.hpp"
+#include "Hash.hpp"
+
+#include <gtest/gtest.h>
+
+static RuleInputs makeInputs(float notesPerSecond, int difficulty)   {
+    return RuleInputs {notesPerSecond, -1.0f, 120.0f, difficulty, hashString("Standard"), nullptr, 0};
+}
+
+TEST(RuleSet, FirstFiringRuleWins)  {
+    std::vector<std::string> errors;
+    RuleSet rules = RuleSet::compile({
+        {"Fast expert+", true, {{"nps", ">", "", 8.0f, true}, {"difficulty", "==", "ExpertPlus", 0.0f, false}}},
+        {"Fast", false, {{"nps", ">", "", 8.0f, true}}}
+    }, errors);
+    ASSERT_TRUE(errors.empty());
+
+    EXPECT_EQ(rules.evaluate(makeInputs(10.0f, 4)), 0);
+    EXPECT_EQ(rules.evaluate(makeInputs(10.0f, 3)), 1);
+    EXPECT_EQ(rules.evaluate(makeInputs(6.0f, 4)), -1);
+    EXPECT_TRUE(rules.getOverride(0));
+    EXPECT_FALSE(rules.getOverride(1));
+    EXPECT_EQ(rules.getName(1), "Fast");
+}
+
+TEST(RuleSet, ComparesNumbers)  {
+    std::vector<std::string> errors;
+    RuleSet rules = RuleSet::compile({
+        {"Below", true, {{"nps", "<", "", 4.0f, true}}},
+        {"At most", true, {{"nps", "<=", "", 5.0f, true}}},
+        {"Equal", true, {{"nps", "==", "", 6.0f, true}}},
+        {"At least", true, {{"nps", ">=", "", 8.0f, true}}},
+        {"Not", true, {{"nps", "!=", "", 7.0f, true}}}
+    }, errors);
+    ASSERT_TRUE(errors.empty());
+
+    EXPECT_EQ(rules.evaluate(makeInputs(3.0f, 0)), 0);
+    EXPECT_EQ(rules.evaluate(makeInputs(5.0f, 0)), 1);
+    EXPECT_EQ(rules.evaluate(makeInputs(6.0f, 0)), 2);
+    EXPECT_EQ(rules.evaluate(makeInputs(8.0f, 0)), 3);
+    EXPECT_EQ(rules.evaluate(makeInputs(7.5f, 0)), 4);
+    EXPECT_EQ(rules.evaluate(makeInputs(7.0f, 0)), -1);
+}
+
+TEST(RuleSet, TracksUsedFields) {
+    std::vector<std::string> errors;
+    RuleSet rules = RuleSet::compile({{"Long", true, {{"duration", ">=", "", 300.0f, true}}}}, errors);
+    EXPECT_TRUE(rules.usesField(RuleField::DURATION));
+    EXPECT_FALSE(rules.usesField(RuleField::NPS));
+    EXPECT_FALSE(rules.usesField(RuleField::PACK));
+}
+
+TEST(RuleSet, ComparesStringsByHash)    {
+    std::vector<std::string> errors;
+    RuleSet rules = RuleSet::compile({
+        {"Not standard", true, {{"characteristic", "!=", "Standard", 0.0f, false}}},
+        {"Pack", true, {{"pack", "==", "Ranked", 0.0f, false}}}
+    }, errors);
+    ASSERT_TRUE(errors.empty());
+
+    RuleInputs inputs = makeInputs(5.0f, 2);
+    EXPECT_EQ(rules.evaluate(inputs), -1);
+
+    uint64_t packHashes[] = {hashString("Other"), hashString("Ranked")};
+    inputs.packHashes = packHashes;
+    inputs.packHashCount = 2;
+    EXPECT_EQ(rules.evaluate(inputs), 1);
+
+    inputs.characteristicHash = hashString("OneSaber");
+    EXPECT_EQ(rules.evaluate(inputs), 0);
+}
+
+TEST(RuleSet, UnknownPeakNeverMatches)  {
+    std::vector<std::string> errors;
+    RuleSet rules = RuleSet::compile({{"Sparse", true, {{"peakNps", "<", "", 4.0f, true}}}}, errors);
+    RuleInputs inputs = makeInputs(5.0f, 2);
+    EXPECT_EQ(rules.evaluate(inputs), -1);
+
+    inputs.peakNotesPerSecond = 3.0f;
+    EXPECT_EQ(rules.evaluate(inputs), 0);
+}
+
+TEST(RuleSet, InvalidRulesAreSkipped)   {
+    std::vector<std::string> errors;
+    RuleSet rules = RuleSet::compile({
+        {"Bad field", true, {{"bpm", ">", "", 200.0f, true}}},
+        {"Bad operator", true, {{"nps", "=>", "", 5.0f, true}}},
+        {"Bad difficulty", true, {{"difficulty", "==", "Impossible", 0.0f, false}}},
+        {"Ordered pack", true, {{"pack", "<", "Ranked", 0.0f, false}}},
+        {"String nps", true, {{"nps", ">", "fast", 0.0f, false}}},
+        {"Valid", false, {{"nps", ">", "", 5.0f, true}}}
+    }, errors);
+
+    EXPECT_EQ(errors.size(), 5u);
+    EXPECT_EQ(rules.evaluate(makeInputs(6.0f, 2)), 0);
+    EXPECT_EQ(rules.getName(0), "Valid");
+    // The invalid rules are kept as written so that the config can be saved without losing them
+    EXPECT_EQ(rules.getDefinitions().size(), 6u);
+    EXPECT_FALSE(rules.usesField(RuleField::PACK));
+}
+
+TEST(RuleSet, ParsesDifficultyNames)    {
+    EXPECT_EQ(parseDifficultyName("Easy"), 0);
+    EXPECT_EQ(parseDifficultyName("ExpertPlus"), 4);
+    EXPECT_EQ(parseDifficultyName("expertplus"), std::nullopt);
+}
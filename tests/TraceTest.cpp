@@ -0,0 +1,179 @@
+#include "Trace.hpp"
+#include "FakeInputSource.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+static const DecisionKey KEY {"custom_level_ABCDEF", "Standard", 3};
+
+static ConfigSnapshot makeConfig()  {
+    ConfigSnapshot config;
+    config.generation = 7;
+    config.mode = Mode::ENABLE;
+    config.notesPerSecondThreshold = 6.5f;
+    config.densityMode = DensityMode::PEAK;
+    config.densityWindow = 3.0f;
+    config.densityPercentile = 0.8f;
+    config.adaptiveMode = true;
+
+    auto playlists = std::make_shared<PlaylistIndex>();
+    playlists->insert("pack_id", "Pack");
+    config.playlists = playlists;
+
+    std::vector<std::string> errors;
+    config.playlistPatterns = std::make_shared<const PackMatcher>(PackMatcher::compile({"Ranked *"}, errors));
+    config.rules = std::make_shared<const RuleSet>(RuleSet::compile({
+        {"Short", false, {{"duration", "<", "", 60.0f, true}, {"characteristic", "==", "Standard", 0.0f, false}}}
+    }, errors));
+
+    auto levelOverrides = std::make_shared<LevelOverrideList>();
+    levelOverrides->set("custom_level_000000", LevelOverride::ALWAYS);
+    levelOverrides->set("custom_level_111111", LevelOverride::NEVER);
+    config.levelOverrides = levelOverrides;
+    return config;
+}
+
+static std::string tracePath(const char* name)  {
+    return ::testing::TempDir() + name;
+}
+
+TEST(Trace, RoundTripsEvents)   {
+    std::string path = tracePath("round-trip.trace");
+    ConfigSnapshot config = makeConfig();
+
+    FakeInputSource source;
+    source.duration = 90.0f;
+    source.performance = MeasuredPerformance::OVER_BUDGET;
+    Trace::RecordingInputSource recording(source);
+    DecisionEngine engine(16);
+    std::optional<Decision> decision = engine.decide(config, KEY, recording);
+    ASSERT_TRUE(decision.has_value());
+    {
+        Trace::Writer writer;
+        ASSERT_TRUE(writer.open(path));
+        writer.writeConfig(1, config);
+        writer.writeSelect(2, KEY);
+        writer.writeDecide(3, KEY, config.generation, 1500, recording.getInputs(), decision);
+        writer.writeLevelStart(4, KEY, true, decision->willOverride);
+        writer.writeClearDecisions(5);
+    }
+
+    Trace::Reader reader;
+    ASSERT_TRUE(reader.open(path));
+    Trace::Event event;
+
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.type, Trace::EventType::CONFIG);
+    EXPECT_EQ(event.timestamp, 1u);
+    ASSERT_TRUE(event.config);
+    const ConfigSnapshot& readConfig = *event.config;
+    EXPECT_EQ(readConfig.generation, config.generation);
+    EXPECT_EQ(readConfig.mode, config.mode);
+    EXPECT_EQ(readConfig.notesPerSecondThreshold, config.notesPerSecondThreshold);
+    EXPECT_EQ(readConfig.densityMode, config.densityMode);
+    EXPECT_EQ(readConfig.densityWindow, config.densityWindow);
+    EXPECT_EQ(readConfig.densityPercentile, config.densityPercentile);
+    EXPECT_EQ(readConfig.adaptiveMode, config.adaptiveMode);
+    EXPECT_TRUE(readConfig.playlists->contains("pack_id", ""));
+    EXPECT_TRUE(readConfig.playlists->contains("", "Pack"));
+    EXPECT_TRUE(readConfig.playlistPatterns->matches("Ranked 12"));
+    ASSERT_EQ(readConfig.rules->getDefinitions().size(), 1u);
+    EXPECT_EQ(readConfig.rules->getName(0), "Short");
+    EXPECT_TRUE(readConfig.rules->usesField(RuleField::CHARACTERISTIC));
+    EXPECT_EQ(readConfig.levelOverrides->find("custom_level_000000"), LevelOverride::ALWAYS);
+    EXPECT_EQ(readConfig.levelOverrides->find("custom_level_111111"), LevelOverride::NEVER);
+
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.type, Trace::EventType::SELECT);
+    EXPECT_EQ(event.key, KEY);
+
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.type, Trace::EventType::DECIDE);
+    EXPECT_EQ(event.key, KEY);
+    EXPECT_EQ(event.configGeneration, config.generation);
+    EXPECT_EQ(event.latency, 1500u);
+    EXPECT_TRUE(event.inputs.wasRequested(Trace::Input::DURATION));
+    EXPECT_TRUE(event.inputs.wasAvailable(Trace::Input::DURATION));
+    EXPECT_EQ(event.inputs.duration, 90.0f);
+    EXPECT_TRUE(event.inputs.wasRequested(Trace::Input::PERFORMANCE));
+    EXPECT_EQ(event.inputs.performance, MeasuredPerformance::OVER_BUDGET);
+    EXPECT_FALSE(event.inputs.wasRequested(Trace::Input::PACKS));
+    ASSERT_TRUE(event.decision.has_value());
+    EXPECT_EQ(event.decision->willOverride, decision->willOverride);
+    EXPECT_EQ(event.decision->reason, decision->reason);
+    EXPECT_EQ(event.decision->rule, decision->rule);
+
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.type, Trace::EventType::LEVEL_START);
+    EXPECT_TRUE(event.multiplayer);
+    EXPECT_EQ(event.willOverride, decision->willOverride);
+
+    ASSERT_TRUE(reader.next(event));
+    EXPECT_EQ(event.type, Trace::EventType::CLEAR_DECISIONS);
+
+    EXPECT_FALSE(reader.next(event));
+    EXPECT_FALSE(reader.failed());
+    remove(path.c_str());
+}
+
+TEST(Trace, TruncatedTraceFails)    {
+    std::string path = tracePath("truncated.trace");
+    {
+        Trace::Writer writer;
+        ASSERT_TRUE(writer.open(path));
+        writer.writeConfig(1, makeConfig());
+        writer.writeSelect(2, KEY);
+    }
+
+    // Cut the select event off part way through
+    FILE* file = fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    std::vector<uint8_t> data(1 << 16);
+    data.resize(fread(data.data(), 1, data.size(), file));
+    fclose(file);
+    file = fopen(path.c_str(), "wb");
+    fwrite(data.data(), 1, data.size() - 4, file);
+    fclose(file);
+
+    Trace::Reader reader;
+    ASSERT_TRUE(reader.open(path));
+    Trace::Event event;
+    EXPECT_TRUE(reader.next(event));
+    EXPECT_FALSE(reader.next(event));
+    EXPECT_TRUE(reader.failed());
+    remove(path.c_str());
+}
+
+TEST(Trace, RejectsOtherFiles)  {
+    std::string path = tracePath("not-a.trace");
+    FILE* file = fopen(path.c_str(), "wb");
+    fputs("not a trace", file);
+    fclose(file);
+
+    Trace::Reader reader;
+    EXPECT_FALSE(reader.open(path));
+    remove(path.c_str());
+}
+
+TEST(Trace, FailedWriteClosesTheFile)  {
+    // Every write to /dev/full fails as if the storage was full
+    FILE* full = fopen("/dev/full", "wb");
+    if(!full)   {GTEST_SKIP() << "/dev/full isn't available";}
+    fclose(full);
+
+    Trace::Writer writer;
+    EXPECT_FALSE(writer.open("/dev/full"));
+    EXPECT_TRUE(writer.failed());
+    EXPECT_FALSE(writer.isOpen());
+    // Later events are dropped rather than buffered
+    writer.writeSelect(1, KEY);
+    writer.flush();
+    EXPECT_FALSE(writer.isOpen());
+
+    // Opening another file starts again
+    std::string path = tracePath("after-failure.trace");
+    ASSERT_TRUE(writer.open(path));
+    EXPECT_FALSE(writer.failed());
+    remove(path.c_str());
+}
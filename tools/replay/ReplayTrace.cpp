@@ -0,0 +1,175 @@
+// Replays a trace recorded by the mod against the decision engine, without the game.
+// Measures the throughput and latency of the decisions, and checks that they match the ones made in game.
+// Usage: replay-trace <trace file> [--iterations N] [--verbose]
+
+#include "Trace.hpp"
+#include "Profiling.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+// Gives the engine the inputs that were recorded for one decision
+class ReplayInputSource : public DecisionInputSource {
+public:
+    explicit ReplayInputSource(const Trace::Inputs& inputs) : inputs(inputs) {}
+
+    std::optional<float> calculateNotesPerSecond() override    {
+        if(!check(Trace::Input::NPS)) {return std::nullopt;}
+        return inputs.notesPerSecond;
+    }
+
+    float calculatePeakNotesPerSecond() override    {
+        if(!check(Trace::Input::PEAK_NPS)) {return -1.0f;}
+        return inputs.peakNotesPerSecond;
+    }
+
+    std::optional<float> calculateDuration() override  {
+        if(!check(Trace::Input::DURATION)) {return std::nullopt;}
+        return inputs.duration;
+    }
+
+    bool findLevelPacks(std::vector<LevelPack>& packs) override {
+        if(!check(Trace::Input::PACKS)) {return false;}
+        packs.insert(packs.end(), inputs.packs.begin(), inputs.packs.end());
+        return true;
+    }
+
+    MeasuredPerformance findMeasuredPerformance() override  {
+        if(!check(Trace::Input::PERFORMANCE)) {return MeasuredPerformance::UNKNOWN;}
+        return inputs.performance;
+    }
+
+    // Set if the engine asked for an input that it didn't ask for in game, which means its cache has diverged from the recording
+    bool askedForUnrecorded = false;
+
+private:
+    const Trace::Inputs& inputs;
+
+    bool check(Trace::Input input)  {
+        if(!inputs.wasRequested(input)) {
+            askedForUnrecorded = true;
+            return false;
+        }
+        return inputs.wasAvailable(input);
+    }
+};
+
+static bool decisionsMatch(const std::optional<Decision>& a, const std::optional<Decision>& b)   {
+    if(a.has_value() != b.has_value())  {return false;}
+    return !a || (a->willOverride == b->willOverride && a->reason == b->reason && a->rule == b->rule);
+}
+
+static const char* describeDecision(const std::optional<Decision>& decision)  {
+    static char description[64];
+    if(!decision)   {return "undecided";}
+    snprintf(description, sizeof(description), "%s (%s, rule %d)", decision->willOverride ? "override" : "no override", reasonToString(decision->reason), decision->rule);
+    return description;
+}
+
+static void printLatencies(const char* name, const LatencyHistogram& histogram)  {
+    printf("%-18s p50 %8.2f us   p90 %8.2f us   p99 %8.2f us   p99.9 %8.2f us   max %8.2f us   mean %8.2f us\n", name,
+        histogram.getPercentile(50) / 1000.0, histogram.getPercentile(90) / 1000.0, histogram.getPercentile(99) / 1000.0,
+        histogram.getPercentile(99.9) / 1000.0, histogram.getMax() / 1000.0, histogram.getMean() / 1000.0);
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    int iterations = 1;
+    bool verbose = false;
+    for(int i = 1; i < argc; i++)   {
+        if(strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)    {
+            iterations = std::max(1, atoi(argv[++i]));
+        }   else if(strcmp(argv[i], "--verbose") == 0)  {
+            verbose = true;
+        }   else    {
+            path = argv[i];
+        }
+    }
+    if(!path)   {
+        fprintf(stderr, "Usage: %s <trace file> [--iterations N] [--verbose]\n", argv[0]);
+        return 2;
+    }
+
+    // Read the whole trace first, so that reading it isn't timed
+    Trace::Reader reader;
+    if(!reader.open(path))  {
+        fprintf(stderr, "%s isn't a trace file\n", path);
+        return 2;
+    }
+    std::vector<Trace::Event> events;
+    Trace::Event event;
+    while(reader.next(event))   {
+        events.push_back(std::move(event));
+    }
+    if(reader.failed()) {
+        fprintf(stderr, "Trace is truncated after %lu events, replaying those\n", (unsigned long) events.size());
+    }
+
+    size_t selections = 0, levelStarts = 0, overriddenStarts = 0, configs = 0;
+    LatencyHistogram recordedLatency;
+    for(const Trace::Event& event : events) {
+        switch(event.type)  {
+            case Trace::EventType::SELECT: selections++; break;
+            case Trace::EventType::LEVEL_START: levelStarts++; overriddenStarts += event.willOverride; break;
+            case Trace::EventType::CONFIG: configs++; break;
+            case Trace::EventType::DECIDE: recordedLatency.record(event.latency); break;
+            default: break;
+        }
+    }
+
+    LatencyHistogram replayLatency;
+    size_t decisions = 0, mismatches = 0, unrecordedInputs = 0, missingConfigs = 0;
+    std::chrono::steady_clock::duration totalTime{};
+
+    for(int iteration = 0; iteration < iterations; iteration++) {
+        // Start from an empty cache every time, like the game does
+        DecisionEngine engine(256);
+        std::unordered_map<uint64_t, std::shared_ptr<const ConfigSnapshot>> configsByGeneration;
+
+        for(const Trace::Event& event : events) {
+            if(event.type == Trace::EventType::CONFIG)  {
+                configsByGeneration[event.config->generation] = event.config;
+            }   else if(event.type == Trace::EventType::CLEAR_DECISIONS)    {
+                engine.clear();
+            }   else if(event.type == Trace::EventType::DECIDE) {
+                // The background thread can still be using an older snapshot when a new one is published
+                auto config = configsByGeneration.find(event.configGeneration);
+                if(config == configsByGeneration.end()) {
+                    missingConfigs++;
+                    continue;
+                }
+
+                ReplayInputSource inputs(event.inputs);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                std::optional<Decision> decision = engine.decide(*config->second, event.key, inputs);
+                std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+                totalTime += elapsed;
+                replayLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                decisions++;
+                unrecordedInputs += inputs.askedForUnrecorded;
+
+                if(!decisionsMatch(decision, event.decision))   {
+                    mismatches++;
+                    if(verbose && iteration == 0)   {
+                        printf("Mismatch at %.3f s for %s %s %d: recorded %s", event.timestamp / 1e9, event.key.levelId.c_str(), event.key.characteristic.c_str(), event.key.difficulty, describeDecision(event.decision));
+                        printf(", replayed %s\n", describeDecision(decision));
+                    }
+                }
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(totalTime).count();
+    printf("Trace: %lu events, %lu configs, %lu selections, %lu level starts (%lu overridden)\n", (unsigned long) events.size(), (unsigned long) configs,
+        (unsigned long) selections, (unsigned long) levelStarts, (unsigned long) overriddenStarts);
+    printf("Replayed %lu decisions over %d iterations, %.0f decisions/s\n", (unsigned long) decisions, iterations, seconds > 0 ? decisions / seconds : 0.0);
+    printLatencies("Replay latency", replayLatency);
+    printLatencies("Recorded latency", recordedLatency);
+    printf("Mismatched decisions: %lu, inputs not in trace: %lu, decisions with unknown config: %lu\n", (unsigned long) mismatches, (unsigned long) unrecordedInputs, (unsigned long) missingConfigs);
+
+    return mismatches == 0 && unrecordedInputs == 0 ? 0 : 1;
+}
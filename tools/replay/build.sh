@@ -0,0 +1,9 @@
+#!/bin/sh
+# Builds the trace replay tool for Linux. It only uses the parts of the mod that don't depend on the game
+set -e
+cd "$(dirname "$0")"
+
+SRC=../../src
+${CXX:-c++} -std=c++2a -O2 -Wall -I../../include -o replay-trace ReplayTrace.cpp \
+    $SRC/Trace.cpp $SRC/DecisionEngine.cpp $SRC/DecisionCache.cpp $SRC/RuleEngine.cpp \
+    $SRC/PlaylistIndex.cpp $SRC/PackMatcher.cpp $SRC/Profiling.cpp $SRC/LevelOverrideList.cpp